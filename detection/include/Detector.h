@@ -12,14 +12,28 @@ enum class YOLOType {
     YOLOv3_TINY
 };
 
+struct Detection {
+    cv::Rect2f box;
+    // COCO class index, 0 for person
+    int cls;
+    float score;
+};
+
 class DETECTION_EXPORT Detector {
 public:
     explicit Detector(const std::array<int64_t, 2> &_inp_dim, YOLOType type = YOLOType::YOLOv3);
 
     ~Detector();
 
+    // persons only
     std::vector<cv::Rect2f> detect(cv::Mat image);
 
+    // detect persons on several images in one forward pass, images may differ in size
+    std::vector<std::vector<cv::Rect2f>> detect(const std::vector<cv::Mat> &images);
+
+    // detections of every class, suppressed per class, for several images in one forward pass
+    std::vector<std::vector<Detection>> detect_all(const std::vector<cv::Mat> &images);
+
 private:
     class Darknet;
 
@@ -30,19 +30,15 @@ namespace {
         return in / un;
     }
 
-    struct Detection {
-        cv::Rect2f bbox;
-        float scr;
-    };
-
+    // boxes only suppress boxes of their own class
     void NMS(std::vector<Detection> &dets, float threshold) {
         std::sort(dets.begin(), dets.end(),
-                  [](const Detection &a, const Detection &b) { return a.scr > b.scr; });
+                  [](const Detection &a, const Detection &b) { return a.score > b.score; });
 
         for (size_t i = 0; i < dets.size(); ++i) {
             dets.erase(std::remove_if(dets.begin() + i + 1, dets.end(),
                                       [&](const Detection &d) {
-                                          return iou(dets[i].bbox, d.bbox) > threshold;
+                                          return d.cls == dets[i].cls && iou(dets[i].box, d.box) > threshold;
                                       }),
                        dets.end());
         }
@@ -74,43 +70,69 @@ Detector::Detector(const std::array<int64_t, 2> &_inp_dim, YOLOType type) {
 Detector::~Detector() = default;
 
 std::vector<cv::Rect2f> Detector::detect(cv::Mat image) {
+    return detect(std::vector<cv::Mat>{image}).front();
+}
+
+std::vector<std::vector<cv::Rect2f>> Detector::detect(const std::vector<cv::Mat> &images) {
+    std::vector<std::vector<cv::Rect2f>> out;
+    for (auto &dets:detect_all(images)) {
+        out.emplace_back();
+        for (auto &d:dets) {
+            if (d.cls == 0) out.back().push_back(d.box);
+        }
+    }
+    return out;
+}
+
+std::vector<std::vector<Detection>> Detector::detect_all(const std::vector<cv::Mat> &images) {
+    if (images.empty()) {
+        return {};
+    }
+
     torch::NoGradGuard no_grad;
 
-    int64_t orig_dim[] = {image.rows, image.cols};
-    image = letterbox_img(image, inp_dim);
-    cv::cvtColor(image, image, cv::COLOR_RGB2BGR);
-    image.convertTo(image, CV_32F, 1.0 / 255);
-
-    auto img_tensor = torch::from_blob(image.data, {1, inp_dim[0], inp_dim[1], 3})
-            .permute({0, 3, 1, 2}).to(torch::kCUDA);
-    auto prediction = net->forward(img_tensor).squeeze_(0);
-    auto[bbox, cls, scr] = threshold_confidence(prediction, confidence_threshold);
-    bbox = bbox.cpu();
-    cls = cls.cpu();
-    scr = scr.cpu();
-
-    auto cls_mask = cls == 0;
-    bbox = bbox.index_select(0, cls_mask.nonzero().squeeze_());
-    scr = scr.masked_select(cls_mask);
-
-    center_to_corner(bbox);
-    inv_letterbox_bbox(bbox, inp_dim, orig_dim);
-
-    auto bbox_acc = bbox.accessor<float, 2>();
-    auto scr_acc = scr.accessor<float, 1>();
-    std::vector<Detection> dets;
-    for (int64_t i = 0; i < bbox_acc.size(0); ++i) {
-        auto d = Detection{cv::Rect2f(bbox_acc[i][0], bbox_acc[i][1], bbox_acc[i][2], bbox_acc[i][3]),
-                           scr_acc[i]};
-        dets.emplace_back(d);
+    std::vector<cv::Mat> inputs;
+    std::vector<torch::Tensor> img_tensors;
+    for (auto &img:images) {
+        auto image = letterbox_img(img, inp_dim);
+        cv::cvtColor(image, image, cv::COLOR_RGB2BGR);
+        image.convertTo(image, CV_32F, 1.0 / 255);
+        img_tensors.push_back(torch::from_blob(image.data, {inp_dim[0], inp_dim[1], 3}));
+        inputs.push_back(image);
     }
 
-    NMS(dets, NMS_threshold);
+    auto img_tensor = torch::stack(img_tensors).permute({0, 3, 1, 2}).to(torch::kCUDA);
+    auto predictions = net->forward(img_tensor);
+
+    std::vector<std::vector<Detection>> out;
+    for (size_t b = 0; b < images.size(); ++b) {
+        int64_t orig_dim[] = {images[b].rows, images[b].cols};
+
+        auto[bbox, cls, scr] = threshold_confidence(predictions[b], confidence_threshold);
+        bbox = bbox.cpu();
+        cls = cls.cpu();
+        scr = scr.cpu();
+
+        center_to_corner(bbox);
+        inv_letterbox_bbox(bbox, inp_dim, orig_dim);
+
+        auto bbox_acc = bbox.accessor<float, 2>();
+        auto cls_acc = cls.accessor<int64_t, 1>();
+        auto scr_acc = scr.accessor<float, 1>();
+        std::vector<Detection> dets;
+        for (int64_t i = 0; i < bbox_acc.size(0); ++i) {
+            auto d = Detection{cv::Rect2f(bbox_acc[i][0], bbox_acc[i][1], bbox_acc[i][2], bbox_acc[i][3]),
+                               static_cast<int>(cls_acc[i]), scr_acc[i]};
+            dets.emplace_back(d);
+        }
+
+        NMS(dets, NMS_threshold);
 
-    auto img_box = cv::Rect2f(0, 0, orig_dim[1], orig_dim[0]);
-    std::vector<cv::Rect2f> out;
-    for (auto &d:dets) {
-        out.push_back(d.bbox & img_box);
+        auto img_box = cv::Rect2f(0, 0, orig_dim[1], orig_dim[0]);
+        for (auto &d:dets) {
+            d.box &= img_box;
+        }
+        out.push_back(std::move(dets));
     }
 
     return out;
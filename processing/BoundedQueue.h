@@ -0,0 +1,121 @@
+#ifndef BOUNDED_QUEUE_H
+#define BOUNDED_QUEUE_H
+
+#include <deque>
+#include <mutex>
+#include <cstdint>
+#include <condition_variable>
+
+// Wakes a thread waiting on several queues at once. Queues sharing a notifier signal it on every push,
+// pop and close, and a waiter reads version() before looking at the queues, then waits for a newer one,
+// so a change made while it was looking is not missed.
+class QueueNotifier {
+public:
+    uint64_t version() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return _version;
+    }
+
+    // block until the version differs from v
+    void wait(uint64_t v) const {
+        std::unique_lock<std::mutex> lock(mutex);
+        changed.wait(lock, [this, v] { return _version != v; });
+    }
+
+    void signal() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            ++_version;
+        }
+        changed.notify_all();
+    }
+
+private:
+    uint64_t _version = 0;
+    mutable std::mutex mutex;
+    mutable std::condition_variable changed;
+};
+
+// Blocking FIFO of limited capacity between two threads. A full queue blocks the producer,
+// which is how a slow consumer pushes back. After close(), remaining items can still be popped.
+template<typename T>
+class BoundedQueue {
+public:
+    // notifier, if given, must outlive the queue
+    explicit BoundedQueue(size_t capacity, QueueNotifier *notifier = nullptr)
+            : capacity(capacity), notifier(notifier) {}
+
+    // block while full, return false if the queue was closed
+    bool push(T item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_full.wait(lock, [this] { return items.size() < capacity || closed; });
+        if (closed) return false;
+        items.push_back(std::move(item));
+        not_empty.notify_one();
+        lock.unlock();
+        if (notifier) notifier->signal();
+        return true;
+    }
+
+    // block while empty, return false once closed and drained
+    bool pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        not_empty.wait(lock, [this] { return !items.empty() || closed; });
+        auto taken = take(item);
+        lock.unlock();
+        if (taken && notifier) notifier->signal();
+        return taken;
+    }
+
+    bool try_pop(T &item) {
+        std::unique_lock<std::mutex> lock(mutex);
+        auto taken = take(item);
+        lock.unlock();
+        if (taken && notifier) notifier->signal();
+        return taken;
+    }
+
+    bool empty() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.empty();
+    }
+
+    bool full() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return items.size() >= capacity;
+    }
+
+    // closed and nothing left to pop
+    bool drained() const {
+        std::lock_guard<std::mutex> lock(mutex);
+        return closed && items.empty();
+    }
+
+    void close() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            closed = true;
+            not_empty.notify_all();
+            not_full.notify_all();
+        }
+        if (notifier) notifier->signal();
+    }
+
+private:
+    bool take(T &item) {
+        if (items.empty()) return false;
+        item = std::move(items.front());
+        items.pop_front();
+        not_full.notify_one();
+        return true;
+    }
+
+    const size_t capacity;
+    std::deque<T> items;
+    bool closed = false;
+    mutable std::mutex mutex;
+    std::condition_variable not_empty, not_full;
+    QueueNotifier *notifier;
+};
+
+#endif //BOUNDED_QUEUE_H
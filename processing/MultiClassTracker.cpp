@@ -0,0 +1,66 @@
+#include "MultiClassTracker.h"
+#include "TaskPool.h"
+
+using namespace std;
+
+MultiClassTracker::MultiClassTracker(const array<int64_t, 2> &dim, vector<ClassConfig> classes,
+                                     TaskPool *pool, shared_ptr<Extractor> extractor) : pool(pool) {
+    // an extractor given is used as is, one loaded here follows the projection of the first DeepSORT class
+    auto own_extractor = !extractor;
+    const ClassConfig *first_deepsort = nullptr;
+    for (auto &c:classes) {
+        for (auto &t:trackers) {
+            if (t.config.cls == c.cls) {
+                throw runtime_error("Class " + to_string(c.cls) + " is tracked twice");
+            }
+        }
+        if (c.deepsort && own_extractor) {
+            if (!first_deepsort) {
+                first_deepsort = &c;
+                extractor = make_shared_extractor(c.options.projection);
+            } else if (c.options.projection != first_deepsort->options.projection) {
+                throw runtime_error("Classes " + to_string(first_deepsort->cls) + " and " + to_string(c.cls) +
+                                    " share the ReID network but name different projections");
+            }
+        }
+        if (!c.options.pool) c.options.pool = pool;
+
+        ClassTracker t;
+        t.config = c;
+        if (c.deepsort) {
+            t.deep = make_unique<DeepSORT>(dim, c.options, extractor);
+        } else {
+            t.sort = make_unique<SORT>(dim, c.options.pool, c.options.association);
+        }
+        trackers.push_back(move(t));
+    }
+}
+
+MultiClassTracker::~MultiClassTracker() = default;
+
+vector<vector<Track>> MultiClassTracker::update(const vector<Detection> &dets, const cv::Mat &image) {
+    for (auto &t:trackers) {
+        t.dets.clear();
+    }
+    for (auto &d:dets) {
+        for (auto &t:trackers) {
+            if (t.config.cls == d.cls) {
+                if (d.score >= t.config.min_score) t.dets.push_back(d.box);
+                break;
+            }
+        }
+    }
+
+    // every tracker sees every frame, with or without detections of its class
+    vector<vector<Track>> out(trackers.size());
+    auto run = [&](size_t k, size_t) {
+        auto &t = trackers[k];
+        out[k] = t.deep ? t.deep->update(t.dets, image) : t.sort->update(t.dets);
+    };
+    if (pool && trackers.size() > 1) {
+        pool->parallel_for(trackers.size(), run);
+    } else {
+        for (size_t k = 0; k < trackers.size(); ++k) run(k, 0);
+    }
+    return out;
+}
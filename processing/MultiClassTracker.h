@@ -0,0 +1,57 @@
+#ifndef MULTI_CLASS_TRACKER_H
+#define MULTI_CLASS_TRACKER_H
+
+#include <array>
+#include <vector>
+#include <memory>
+#include <opencv2/opencv.hpp>
+
+#include "Detector.h"
+#include "SORT.h"
+#include "DeepSORT.h"
+
+struct ClassConfig {
+    // COCO class index
+    int cls;
+    // detections of the class scoring lower are not tracked
+    float min_score = 0.1f;
+    // the ReID network is trained on persons, other classes are better left to SORT
+    bool deepsort = false;
+    // SORT only takes the association options
+    DeepSORTOptions options;
+};
+
+// Routes the detections of one detection pass to a tracker per class.
+// The class trackers update in parallel on the pool if there is one, and give out IDs independently.
+class MultiClassTracker {
+public:
+    // pool, if given, must outlive the tracker, extractor is shared by the DeepSORT trackers.
+    // Without one, the DeepSORT classes must name the same projection
+    MultiClassTracker(const std::array<int64_t, 2> &dim, std::vector<ClassConfig> classes,
+                      TaskPool *pool = nullptr, std::shared_ptr<Extractor> extractor = nullptr);
+
+    ~MultiClassTracker();
+
+    // tracks of each class, in the order of the configs
+    std::vector<std::vector<Track>> update(const std::vector<Detection> &dets, const cv::Mat &image);
+
+    size_t size() const { return trackers.size(); }
+
+    const ClassConfig &config(size_t k) const { return trackers[k].config; }
+
+    // detections given to the tracker of config k in the last update
+    const std::vector<cv::Rect2f> &detections(size_t k) const { return trackers[k].dets; }
+
+private:
+    struct ClassTracker {
+        ClassConfig config;
+        std::unique_ptr<SORT> sort;
+        std::unique_ptr<DeepSORT> deep;
+        std::vector<cv::Rect2f> dets;
+    };
+
+    std::vector<ClassTracker> trackers;
+    TaskPool *pool;
+};
+
+#endif //MULTI_CLASS_TRACKER_H
@@ -0,0 +1,135 @@
+#include <experimental/filesystem>
+#include <iostream>
+#include <iomanip>
+#include <thread>
+#include <chrono>
+
+#include "StreamServer.h"
+#include "util.h"
+#include "config.h"
+
+using namespace std;
+namespace fs = std::experimental::filesystem;
+
+StreamServer::Stream::Stream(const string &path, QueueNotifier &notifier)
+        : cap(path), decoded(queue_size, &notifier), detected(queue_size, &notifier) {
+    if (!cap.isOpened()) {
+        throw runtime_error("Cannot open cv::VideoCapture " + path);
+    }
+    orig_dim = {int64_t(cap.get(cv::CAP_PROP_FRAME_HEIGHT)), int64_t(cap.get(cv::CAP_PROP_FRAME_WIDTH))};
+    fps = static_cast<int>(cap.get(cv::CAP_PROP_FPS));
+}
+
+StreamServer::StreamServer(const vector<string> &input_paths, int scale_factor) {
+    // every image of a batch is letterboxed to the same size, big enough for the largest stream
+    array<int64_t, 2> max_dim{0, 0};
+    for (auto &path:input_paths) {
+        streams.push_back(make_unique<Stream>(path, queue_changed));
+        for (size_t i = 0; i < 2; ++i) {
+            max_dim[i] = max(max_dim[i], streams.back()->orig_dim[i]);
+        }
+    }
+    detector = make_unique<Detector>(detector_dim(max_dim, scale_factor));
+    extractor = make_shared_extractor();
+
+    DeepSORTOptions options;
+    options.pool = &pool;
+    for (size_t i = 0; i < streams.size(); ++i) {
+        auto &s = *streams[i];
+        s.tracker = make_unique<DeepSORT>(s.orig_dim, options, extractor);
+        s.repo = make_unique<TargetStorage>(s.orig_dim, s.fps,
+                                            (fs::path(OUTPUT_DIR) / ("stream" + to_string(i))).string());
+    }
+}
+
+StreamServer::~StreamServer() = default;
+
+void StreamServer::run() {
+    auto start = chrono::steady_clock::now();
+
+    vector<thread> readers;
+    for (auto &s:streams) {
+        readers.emplace_back(&StreamServer::read, this, ref(*s));
+    }
+    detect();
+    for (auto &t:readers) {
+        t.join();
+    }
+    pool.wait();
+
+    for (size_t i = 0; i < streams.size(); ++i) {
+        auto &s = *streams[i];
+        auto seconds = chrono::duration<double>(s.last_frame - start).count();
+        cout << "Stream " << i << ": " << s.n_frames << " frames, "
+             << "FPS: " << fixed << setprecision(2) << s.n_frames / seconds << endl;
+    }
+}
+
+void StreamServer::read(Stream &s) {
+    for (int index = 0;; ++index) {
+        cv::Mat image;
+        if (!s.cap.read(image) || !s.decoded.push({index, image, {}})) break;
+    }
+    s.decoded.close();
+}
+
+void StreamServer::detect() {
+    vector<Stream *> owners;
+    vector<Frame> batch;
+    vector<cv::Mat> images;
+    while (true) {
+        owners.clear();
+        batch.clear();
+        images.clear();
+
+        // read before looking at the queues, so that a change while looking ends the wait below at once
+        auto version = queue_changed.version();
+        auto open = false;
+        for (auto &s:streams) {
+            if (s->decoded.drained()) continue;
+            open = true;
+
+            // only this thread pushes to detected, so a queue that is not full has room for the frame
+            Frame f;
+            if (!s->detected.full() && s->decoded.try_pop(f)) {
+                owners.push_back(s.get());
+                images.push_back(f.image);
+                batch.push_back(move(f));
+            }
+        }
+        if (!open) break;
+        if (batch.empty()) {
+            // until a reader pushes a frame or closes, or a tracker frees room in detected
+            queue_changed.wait(version);
+            continue;
+        }
+
+        auto dets = detector->detect(images);
+        for (size_t k = 0; k < batch.size(); ++k) {
+            batch[k].dets = move(dets[k]);
+            owners[k]->detected.push(move(batch[k]));
+            schedule(*owners[k]);
+        }
+    }
+}
+
+void StreamServer::schedule(Stream &s) {
+    if (!s.scheduled.exchange(true)) {
+        pool.submit([this, &s] { track(s); });
+    }
+}
+
+void StreamServer::track(Stream &s) {
+    Frame f;
+    while (true) {
+        while (s.detected.try_pop(f)) {
+            auto trks = s.tracker->update(f.dets, f.image);
+            s.repo->update(trks, f.index, f.image);
+            ++s.n_frames;
+            s.last_frame = chrono::steady_clock::now();
+        }
+        s.scheduled = false;
+        // a frame pushed after the last pop did not schedule a task, take it unless another task did
+        if (s.detected.empty() || s.scheduled.exchange(true)) return;
+    }
+}
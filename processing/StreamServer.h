@@ -0,0 +1,79 @@
+#ifndef STREAM_SERVER_H
+#define STREAM_SERVER_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include <memory>
+#include <atomic>
+#include <chrono>
+#include <opencv2/opencv.hpp>
+
+#include "Detector.h"
+#include "DeepSORT.h"
+#include "TaskPool.h"
+#include "TargetStorage.h"
+#include "BoundedQueue.h"
+
+// Tracks several video sources in one process.
+// A reader thread per stream decodes frames, the frames available from all streams are detected
+// in one batch by a shared Detector, and each stream runs its own DeepSORT and TargetStorage
+// as tasks on a shared pool, which also takes their crop preprocessing and assignment.
+// All trackers share one ReID network.
+// Streams have bounded queues, and a stream whose tracker falls behind is left out of the batches
+// until it catches up, so it only holds back its own reader.
+class StreamServer {
+public:
+    StreamServer(const std::vector<std::string> &input_paths, int scale_factor);
+
+    ~StreamServer();
+
+    // return when all streams are processed
+    void run();
+
+private:
+    struct Frame {
+        int index;
+        cv::Mat image;
+        std::vector<cv::Rect2f> dets;
+    };
+
+    struct Stream {
+        // the queues signal notifier
+        Stream(const std::string &path, QueueNotifier &notifier);
+
+        cv::VideoCapture cap;
+        std::array<int64_t, 2> orig_dim;
+        int fps;
+
+        static const size_t queue_size = 4;
+        BoundedQueue<Frame> decoded, detected;
+
+        std::unique_ptr<DeepSORT> tracker;
+        std::unique_ptr<TargetStorage> repo;
+
+        // set while a task is draining detected, so frames of a stream are tracked in order
+        std::atomic<bool> scheduled{false};
+        int n_frames = 0;
+        std::chrono::steady_clock::time_point last_frame;
+    };
+
+    void read(Stream &s);
+
+    void detect();
+
+    void schedule(Stream &s);
+
+    void track(Stream &s);
+
+    // destroyed last, after the trackers using it
+    TaskPool pool;
+    // signalled by the queues of all streams, the detection thread waits on it when no stream has a frame to detect
+    QueueNotifier queue_changed;
+
+    std::vector<std::unique_ptr<Stream>> streams;
+    std::unique_ptr<Detector> detector;
+    std::shared_ptr<Extractor> extractor;
+};
+
+#endif //STREAM_SERVER_H
@@ -9,9 +9,10 @@
 using namespace std;
 namespace fs = std::experimental::filesystem;
 
-TargetStorage::TargetStorage(const array<int64_t, 2> &orig_dim, int video_FPS) {
-    fs::create_directories(OUTPUT_DIR);
-    writer.open((fs::path(OUTPUT_DIR) / VIDEO_NAME).string(),
+TargetStorage::TargetStorage(const array<int64_t, 2> &orig_dim, int video_FPS, string output_dir)
+        : output_dir(move(output_dir)) {
+    fs::create_directories(this->output_dir);
+    writer.open((fs::path(this->output_dir) / VIDEO_NAME).string(),
                 cv::VideoWriter::fourcc('a', 'v', 'c', '1'),
                 video_FPS, cv::Size(orig_dim[1], orig_dim[0]));
     if (!writer.isOpened()) {
@@ -39,7 +40,7 @@ void TargetStorage::update(const vector<Track> &trks, int frame, const cv::Mat &
 
 void TargetStorage::record(int remain) {
     for (auto&[id, t]:targets) {
-        auto dir_path = fs::path(OUTPUT_DIR) / TARGETS_DIR_NAME / to_string(id);
+        auto dir_path = fs::path(output_dir) / TARGETS_DIR_NAME / to_string(id);
         fs::create_directories(dir_path);
 
         ofstream fp(dir_path / TRAJ_TXT_NAME, ios::app);
@@ -4,6 +4,7 @@
 #include <map>
 #include <array>
 #include <utility>
+#include <string>
 #include <opencv2/opencv.hpp>
 
 #include "Track.h"
@@ -11,7 +12,7 @@
 
 class TargetStorage {
 public:
-    explicit TargetStorage(const std::array<int64_t, 2> &orig_dim, int video_FPS);
+    TargetStorage(const std::array<int64_t, 2> &orig_dim, int video_FPS, std::string output_dir);
 
     virtual ~TargetStorage() { record(0); }
 
@@ -31,6 +32,8 @@ private:
 
     static constexpr float padding = 0.1f;
 
+    std::string output_dir;
+
     std::map<int, Target> targets;
 
     cv::VideoWriter writer;
@@ -1,20 +1,62 @@
+#include <experimental/filesystem>
 #include <iostream>
 #include <sstream>
 #include <opencv2/opencv.hpp>
 #include <chrono>
 
 #include "Detector.h"
-#include "DeepSORT.h"
+#include "MultiClassTracker.h"
+#include "TaskPool.h"
 #include "TargetStorage.h"
+#include "StreamServer.h"
+#include "config.h"
 
 using namespace std;
+namespace fs = std::experimental::filesystem;
+
+namespace {
+    const char *usage = "usage: processing <input path> [<scale factor>] [--classes <class>[:<min score>],...]\n"
+                        "       processing --streams <scale factor> <input path>...";
+
+    // "0,2:0.5" tracks persons and cars, cars scoring at least 0.5. Persons get DeepSORT, other classes SORT
+    vector<ClassConfig> parse_classes(const string &list) {
+        vector<ClassConfig> classes;
+        stringstream in(list);
+        string item;
+        while (getline(in, item, ',')) {
+            ClassConfig c;
+            auto colon = item.find(':');
+            c.cls = stoi(item.substr(0, colon));
+            if (colon != string::npos) c.min_score = stof(item.substr(colon + 1));
+            c.deepsort = c.cls == 0;
+            classes.push_back(c);
+        }
+        return classes;
+    }
+}
 
 int main(int argc, const char *argv[]) {
-    if (argc < 2 || argc > 3) {
-        throw runtime_error("usage: processing <input path> [<scale factor>]");
+    if (argc >= 4 && string(argv[1]) == "--streams") {
+        StreamServer server(vector<string>(argv + 3, argv + argc), stoi(argv[2]));
+        server.run();
+        return 0;
+    }
+    if (argc < 2) {
+        throw runtime_error(usage);
     }
     auto input_path = string(argv[1]);
-    auto scale_factor = argc == 3 ? stoi(argv[2]) : 1;
+    auto scale_factor = 1;
+    auto classes = parse_classes("0");
+    for (int i = 2; i < argc; ++i) {
+        auto arg = string(argv[i]);
+        if (i + 1 < argc && arg == "--classes") {
+            classes = parse_classes(argv[++i]);
+        } else if (i == 2 && arg.substr(0, 2) != "--") {
+            scale_factor = stoi(arg);
+        } else {
+            throw runtime_error(usage);
+        }
+    }
 
     cv::VideoCapture cap(input_path);
     if (!cap.isOpened()) {
@@ -22,15 +64,17 @@ int main(int argc, const char *argv[]) {
     }
 
     array<int64_t, 2> orig_dim{int64_t(cap.get(cv::CAP_PROP_FRAME_HEIGHT)), int64_t(cap.get(cv::CAP_PROP_FRAME_WIDTH))};
-    array<int64_t, 2> inp_dim;
-    for (size_t i = 0; i < 2; ++i) {
-        auto factor = 1 << 5;
-        inp_dim[i] = (orig_dim[i] / scale_factor / factor + 1) * factor;
-    }
-    Detector detector(inp_dim);
-    DeepSORT tracker(orig_dim);
+    Detector detector(detector_dim(orig_dim, scale_factor));
+    TaskPool pool;
+    MultiClassTracker tracker(orig_dim, classes, &pool);
 
-    TargetStorage repo(orig_dim, static_cast<int>(cap.get(cv::CAP_PROP_FPS)));
+    // with several classes, IDs are per class and the results of class c go to result/class<c>
+    vector<unique_ptr<TargetStorage>> repos;
+    for (size_t k = 0; k < tracker.size(); ++k) {
+        auto dir = tracker.size() == 1 ? OUTPUT_DIR
+                                       : (fs::path(OUTPUT_DIR) / ("class" + to_string(tracker.config(k).cls))).string();
+        repos.push_back(make_unique<TargetStorage>(orig_dim, static_cast<int>(cap.get(cv::CAP_PROP_FPS)), dir));
+    }
 
     auto image = cv::Mat();
     cv::namedWindow("Output", cv::WINDOW_NORMAL | cv::WINDOW_KEEPRATIO);
@@ -39,10 +83,12 @@ int main(int argc, const char *argv[]) {
 
         auto start = chrono::steady_clock::now();
 
-        auto dets = detector.detect(image);
+        auto dets = detector.detect_all({image}).front();
         auto trks = tracker.update(dets, image);
 
-        repo.update(trks, frame_processed, image);
+        for (size_t k = 0; k < trks.size(); ++k) {
+            repos[k]->update(trks[k], frame_processed, image);
+        }
 
         stringstream str;
         str << "Frame: " << frame_processed << "/" << cap.get(cv::CAP_PROP_FRAME_COUNT) << ", "
@@ -50,12 +96,17 @@ int main(int argc, const char *argv[]) {
             << 1000.0 / chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start).count();
         draw_text(image, str.str(), {0, 0, 0}, {image.cols, 0}, true);
 
-        for (auto &d:dets) {
-            draw_bbox(image, d);
+        for (size_t k = 0; k < trks.size(); ++k) {
+            for (auto &d:tracker.detections(k)) {
+                draw_bbox(image, d);
+            }
         }
-        for (auto &t:trks) {
-            draw_bbox(image, t.box, to_string(t.id), color_map(t.id));
-            draw_trajectories(image, repo.get().at(t.id).trajectories, color_map(t.id));
+        for (size_t k = 0; k < trks.size(); ++k) {
+            auto prefix = trks.size() == 1 ? string() : to_string(tracker.config(k).cls) + ":";
+            for (auto &t:trks[k]) {
+                draw_bbox(image, t.box, prefix + to_string(t.id), color_map(t.id));
+                draw_trajectories(image, repos[k]->get().at(t.id).trajectories, color_map(t.id));
+            }
         }
 
         cv::imshow("Output", image);
@@ -4,6 +4,16 @@
 #include <opencv2/opencv.hpp>
 
 namespace {
+    // detector input size for a video, downscaled and rounded up to a multiple of the network stride
+    std::array<int64_t, 2> detector_dim(const std::array<int64_t, 2> &orig_dim, int scale_factor) {
+        std::array<int64_t, 2> inp_dim;
+        for (size_t i = 0; i < 2; ++i) {
+            auto factor = 1 << 5;
+            inp_dim[i] = (orig_dim[i] / scale_factor / factor + 1) * factor;
+        }
+        return inp_dim;
+    }
+
     cv::Rect2f pad_rect(cv::Rect2f rect, float padding) {
         rect.x = std::max(0.0f, rect.x - rect.width * padding);
         rect.y = std::max(0.0f, rect.y - rect.height * padding);
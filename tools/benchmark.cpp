@@ -0,0 +1,170 @@
+// Run trackers over MOTChallenge sequences with ground truth and report accuracy and speed together.
+
+#include <experimental/filesystem>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+#include "mot.h"
+#include "metrics.h"
+#include "run_tracker.h"
+
+using namespace std;
+namespace fs = std::experimental::filesystem;
+
+namespace {
+    const char *usage = "usage: benchmark <sequence dir>... [--deepsort] [--both] [--min-score <score>]\n"
+                        "                 [--appearance <full|ema|kmeans>...] [--association <optimal|greedy|auction>]\n"
+                        "                 [--report <report.json>]";
+
+    string sequence_name(string dir) {
+        while (dir.size() > 1 && (dir.back() == '/' || dir.back() == '\\')) dir.pop_back();
+        return fs::path(dir).filename().string();
+    }
+
+    struct Result {
+        string sequence, tracker;
+        int64_t frames;
+        double seconds, association_time, extraction_time;
+        // largest memory held by the tracker state during the run, measured per run so configs compare
+        double memory_mb;
+        MOTMetrics metrics;
+        AssignmentStats assignment;
+    };
+
+    void write_json(ostream &out, const Result &r) {
+        auto &m = r.metrics;
+        out << "{\"sequence\": \"" << r.sequence << "\", \"tracker\": \"" << r.tracker << "\", "
+            << "\"frames\": " << r.frames << ", "
+            << "\"fps\": " << r.frames / max(r.seconds, 1e-9) << ", "
+            << "\"association_ms\": " << r.association_time * 1000 / max<int64_t>(r.frames, 1) << ", "
+            << "\"extraction_ms\": " << r.extraction_time * 1000 / max<int64_t>(r.frames, 1) << ", "
+            << "\"tracker_memory_mb\": " << r.memory_mb << ", "
+            << "\"assignments_checked\": " << r.assignment.checked << ", "
+            << "\"assignments_deviating\": " << r.assignment.deviating << ", "
+            << "\"assignment_excess_cost\": " << r.assignment.excess_cost << ", "
+            << "\"auctions_over_budget\": " << r.assignment.over_budget << ", "
+            << "\"mota\": " << m.mota() << ", \"motp\": " << m.motp() << ", \"idf1\": " << m.idf1() << ", "
+            << "\"id_switches\": " << m.id_switches << ", \"fragmentations\": " << m.fragmentations << ", "
+            << "\"false_positives\": " << m.false_positives << ", \"misses\": " << m.misses << ", "
+            << "\"gt\": " << m.gt << "}";
+    }
+
+    void print(const Result &r) {
+        auto &m = r.metrics;
+        cout << left << setw(20) << r.sequence << setw(16) << r.tracker << right
+             << " MOTA " << setw(6) << m.mota() * 100 << " IDF1 " << setw(6) << m.idf1() * 100
+             << " IDSW " << setw(5) << m.id_switches << " Frag " << setw(5) << m.fragmentations
+             << " FPS " << setw(8) << r.frames / max(r.seconds, 1e-9) << endl;
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    vector<string> seq_dirs;
+    vector<bool> trackers{false};
+    vector<string> appearances;
+    auto association = AssociationMode::Optimal;
+    auto min_score = 0.0f;
+    string report_path = "benchmark.json";
+    for (int i = 1; i < argc; ++i) {
+        auto arg = string(argv[i]);
+        if (arg == "--deepsort") {
+            trackers = {true};
+        } else if (arg == "--both") {
+            trackers = {false, true};
+        } else if (i + 1 < argc && arg == "--appearance") {
+            appearances.push_back(argv[++i]);
+        } else if (i + 1 < argc && arg == "--association") {
+            association = parse_association(argv[++i]);
+        } else if (i + 1 < argc && arg == "--min-score") {
+            min_score = stof(argv[++i]);
+        } else if (i + 1 < argc && arg == "--report") {
+            report_path = argv[++i];
+        } else if (arg.substr(0, 2) == "--") {
+            throw runtime_error(usage);
+        } else {
+            seq_dirs.push_back(arg);
+        }
+    }
+    if (seq_dirs.empty()) {
+        throw runtime_error(usage);
+    }
+    if (!appearances.empty() && find(trackers.begin(), trackers.end(), true) == trackers.end()) {
+        throw runtime_error(string("--appearance needs --deepsort or --both\n") + usage);
+    }
+
+    // DeepSORT runs once per appearance model
+    struct Config {
+        string name;
+        bool deepsort;
+        DeepSORTOptions options;
+    };
+    vector<Config> configs;
+    for (auto deepsort:trackers) {
+        if (!deepsort) {
+            configs.push_back({"SORT", false, {}});
+            continue;
+        }
+        if (appearances.empty()) {
+            configs.push_back({"DeepSORT", true, {}});
+        }
+        for (auto &a:appearances) {
+            DeepSORTOptions options;
+            options.appearance = parse_appearance(a);
+            configs.push_back({"DeepSORT/" + a, true, options});
+        }
+    }
+    for (auto &config:configs) {
+        config.options.association.mode = association;
+    }
+
+    cout << fixed << setprecision(2);
+    vector<Result> results, totals;
+    for (auto &config:configs) {
+        Result total{"OVERALL", config.name, 0, 0, 0, 0, 0, {}, {}};
+        for (auto &dir:seq_dirs) {
+            auto info = read_seqinfo(dir);
+            if (info.dim[0] <= 0 || info.dim[1] <= 0) {
+                throw runtime_error("Frame size is missing in seqinfo.ini of " + dir);
+            }
+            auto dets = boxes_by_frame(read_mot((fs::path(dir) / "det" / "det.txt").string()), info, min_score);
+            auto gt = read_mot((fs::path(dir) / "gt" / "gt.txt").string());
+
+            auto run = run_tracker(info, dets, config.deepsort, config.options);
+            Result r{sequence_name(dir), total.tracker, int64_t(run.frames.size()), run.seconds(),
+                     run.stats.association_time, run.stats.extraction_time, run.peak_bytes / 1048576.0,
+                     evaluate(gt, run.tracks), run.stats.assignment};
+            print(r);
+            results.push_back(r);
+
+            total.frames += r.frames;
+            total.seconds += r.seconds;
+            total.association_time += r.association_time;
+            total.extraction_time += r.extraction_time;
+            total.memory_mb = max(total.memory_mb, r.memory_mb);
+            total.metrics += r.metrics;
+            total.assignment.checked += r.assignment.checked;
+            total.assignment.deviating += r.assignment.deviating;
+            total.assignment.excess_cost += r.assignment.excess_cost;
+            total.assignment.over_budget += r.assignment.over_budget;
+        }
+        print(total);
+        totals.push_back(total);
+    }
+
+    ofstream report(report_path);
+    report << setprecision(6) << "{\n  \"sequences\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        report << "    ";
+        write_json(report, results[i]);
+        report << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    report << "  ],\n  \"overall\": [\n";
+    for (size_t i = 0; i < totals.size(); ++i) {
+        report << "    ";
+        write_json(report, totals[i]);
+        report << (i + 1 < totals.size() ? ",\n" : "\n");
+    }
+    report << "  ]\n}\n";
+}
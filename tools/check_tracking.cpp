@@ -0,0 +1,179 @@
+// Check the assignment solvers against brute force on small random problems, and that a SORT snapshot resumes
+// tracking exactly. Exits with 1 if any check fails.
+
+#include <array>
+#include <cmath>
+#include <iostream>
+#include <random>
+#include <string>
+
+#include "LAPJV.h"
+#include "SparseAssignment.h"
+#include "SORT.h"
+#include "TaskPool.h"
+
+using namespace std;
+
+namespace {
+    const char *usage = "usage: check_tracking [--cases <n>] [--seed <seed>]";
+
+    const float tolerance = 1e-4f;
+
+    int failures = 0;
+
+    void fail(const string &what, int64_t c) {
+        if (++failures <= 10) {
+            cerr << what << " failed on case " << c << endl;
+        }
+    }
+
+    // total cost of an assignment, rows left unassigned cost cost_limit. NAN if it is not a valid assignment
+    float total_cost(const CostView &cost, float cost_limit, const vector<int> &row_to_col) {
+        if (row_to_col.size() != size_t(cost.rows)) return NAN;
+        vector<uint8_t> used(cost.cols);
+        auto total = 0.0f;
+        for (int64_t i = 0; i < cost.rows; ++i) {
+            auto j = row_to_col[i];
+            if (j == -1) {
+                total += cost_limit;
+                continue;
+            }
+            if (j < 0 || j >= cost.cols || used[j] || cost(i, j) > cost_limit) return NAN;
+            used[j] = 1;
+            total += cost(i, j);
+        }
+        return total;
+    }
+
+    // minimum total cost over all assignments of rows from i on, with the columns in used taken
+    float brute_force(const CostView &cost, float cost_limit, int64_t i, vector<uint8_t> &used) {
+        if (i == cost.rows) return 0;
+        auto best = cost_limit + brute_force(cost, cost_limit, i + 1, used);
+        for (int64_t j = 0; j < cost.cols; ++j) {
+            if (used[j] || cost(i, j) > cost_limit) continue;
+            used[j] = 1;
+            best = min(best, cost(i, j) + brute_force(cost, cost_limit, i + 1, used));
+            used[j] = 0;
+        }
+        return best;
+    }
+
+    void check_assignment(int64_t n_cases, mt19937 &rng) {
+        uniform_int_distribution<int> size(1, 6);
+        uniform_real_distribution<float> unit(0, 1), dual(-2, 2);
+        TaskPool pool(2);
+
+        LAPJV lapjv;
+        SparseAssignment sparse, pooled(&pool);
+        AssociationOptions greedy_options, auction_options;
+        greedy_options.mode = AssociationMode::Greedy;
+        auction_options.mode = AssociationMode::Auction;
+        auction_options.time_budget_ms = 1000;
+        SparseAssignment greedy(nullptr, greedy_options), auction(nullptr, auction_options);
+
+        for (int64_t c = 0; c < n_cases; ++c) {
+            auto rows = size(rng), cols = size(rng);
+            auto density = unit(rng);
+            auto cost_limit = 0.5f + unit(rng);
+            vector<float> buf(rows * cols);
+            vector<CostEntry> entries;
+            for (int i = 0; i < rows; ++i) {
+                for (int j = 0; j < cols; ++j) {
+                    auto &d = buf[i * cols + j];
+                    d = unit(rng) < density ? unit(rng) : INVALID_DIST;
+                    if (d < INVALID_DIST) entries.push_back({i, j, d});
+                }
+            }
+            CostView cost(buf.data(), rows, cols);
+            vector<uint8_t> used(cols);
+            auto best = brute_force(cost, cost_limit, 0, used);
+
+            // every exact solver, cold and from arbitrary starting duals
+            vector<int> row_to_col;
+            vector<float> duals(rows);
+            auto check_exact = [&](const string &what) {
+                if (!(fabs(total_cost(cost, cost_limit, row_to_col) - best) <= tolerance)) fail(what, c);
+            };
+            for (auto warm:{false, true}) {
+                auto start = [&] {
+                    for (auto &u:duals) u = warm ? dual(rng) : 0;
+                    return warm ? duals.data() : nullptr;
+                };
+                auto name = string(warm ? " warm" : " cold");
+                lapjv.solve(cost, cost_limit, row_to_col, start());
+                check_exact("LAPJV" + name);
+                sparse.solve(cost, cost_limit, row_to_col, start());
+                check_exact("SparseAssignment dense" + name);
+                sparse.solve(CostMatrix::sparse(rows, cols, entries), cost_limit, row_to_col, start());
+                check_exact("SparseAssignment sparse" + name);
+                pooled.solve(cost, cost_limit, row_to_col, start());
+                check_exact("SparseAssignment pooled" + name);
+            }
+
+            // approximate modes give valid assignments, a finished auction is within epsilon per row
+            greedy.solve(cost, cost_limit, row_to_col);
+            if (!(total_cost(cost, cost_limit, row_to_col) >= best - tolerance)) fail("greedy", c);
+            auction.solve(cost, cost_limit, row_to_col);
+            auto bound = best + rows * auction_options.epsilon + tolerance;
+            if (!(total_cost(cost, cost_limit, row_to_col) <= bound)) fail("auction", c);
+        }
+        if (auction.stats().over_budget) fail("auction budget", n_cases);
+    }
+
+    // a restored SORT tracks exactly as the one it was taken from
+    void check_snapshot(mt19937 &rng) {
+        const array<int64_t, 2> dim{480, 640};
+        uniform_real_distribution<float> pos(0, 560), step(-3, 3), unit(0, 1);
+        vector<cv::Rect2f> targets(20);
+        for (auto &t:targets) {
+            t = cv::Rect2f(pos(rng), pos(rng) * 0.7f, 40, 80);
+        }
+        auto frame = [&] {
+            vector<cv::Rect2f> dets;
+            for (auto &t:targets) {
+                t.x += step(rng);
+                t.y += step(rng);
+                if (unit(rng) < 0.9f) dets.push_back(t);
+            }
+            return dets;
+        };
+
+        SORT original(dim), restored(dim);
+        for (int f = 0; f < 30; ++f) {
+            original.update(frame());
+        }
+        auto snapshot = original.snapshot();
+        restored.restore(snapshot);
+        if (restored.snapshot() != snapshot) fail("SORT snapshot round-trip", 0);
+        for (int f = 0; f < 30; ++f) {
+            auto dets = frame();
+            auto a = original.update(dets), b = restored.update(dets);
+            auto same = a.size() == b.size();
+            for (size_t k = 0; same && k < a.size(); ++k) {
+                same = a[k].id == b[k].id && a[k].box == b[k].box;
+            }
+            if (!same) fail("SORT restored tracking", f);
+        }
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    int64_t n_cases = 20000;
+    unsigned seed = 1;
+    for (int i = 1; i < argc; ++i) {
+        auto arg = string(argv[i]);
+        if (i + 1 < argc && arg == "--cases") {
+            n_cases = stoll(argv[++i]);
+        } else if (i + 1 < argc && arg == "--seed") {
+            seed = stoul(argv[++i]);
+        } else {
+            throw runtime_error(usage);
+        }
+    }
+
+    mt19937 rng(seed);
+    check_assignment(n_cases, rng);
+    check_snapshot(rng);
+    cout << (failures ? to_string(failures) + " checks failed" : "all checks passed") << endl;
+    return failures ? 1 : 0;
+}
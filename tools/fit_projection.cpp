@@ -0,0 +1,103 @@
+// Fit the PCA projection of ReID features used by DeepSORTOptions::projection,
+// on crops of the ground truth boxes of MOTChallenge sequences.
+
+#include <experimental/filesystem>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+
+#include "Extractor.h"
+#include "mot.h"
+
+using namespace std;
+namespace fs = std::experimental::filesystem;
+
+namespace {
+    const char *usage = "usage: fit_projection <output file> <dimensions> <sequence dir>... [--max-crops <n>]";
+
+    const size_t batch_size = 64;
+
+    struct Sample {
+        size_t seq;
+        int frame;
+        cv::Rect2f box;
+    };
+}
+
+int main(int argc, const char *argv[]) {
+    if (argc < 4) {
+        throw runtime_error(usage);
+    }
+    auto out_path = string(argv[1]);
+    auto dims = stoi(argv[2]);
+    size_t max_crops = 20000;
+    vector<string> seq_dirs;
+    for (int i = 3; i < argc; ++i) {
+        auto arg = string(argv[i]);
+        if (i + 1 < argc && arg == "--max-crops") {
+            max_crops = stoul(argv[++i]);
+        } else if (arg.substr(0, 2) == "--") {
+            throw runtime_error(usage);
+        } else {
+            seq_dirs.push_back(arg);
+        }
+    }
+
+    vector<SequenceInfo> infos;
+    vector<Sample> samples;
+    for (size_t s = 0; s < seq_dirs.size(); ++s) {
+        infos.push_back(read_seqinfo(seq_dirs[s]));
+        for (auto &b:read_mot((fs::path(seq_dirs[s]) / "gt" / "gt.txt").string())) {
+            if (b.score != 0) samples.push_back({s, b.frame, b.box});
+        }
+    }
+    // a fixed random subset, read in frame order
+    shuffle(samples.begin(), samples.end(), mt19937(0));
+    samples.resize(min(samples.size(), max_crops));
+    sort(samples.begin(), samples.end(), [](const Sample &a, const Sample &b) {
+        return tie(a.seq, a.frame) < tie(b.seq, b.frame);
+    });
+
+    Extractor extractor;
+    cv::Mat data(0, int(extractor.feat_dim()), CV_32F);
+    vector<cv::Mat> crops;
+    auto flush = [&] {
+        if (crops.empty()) return;
+        torch::Tensor feats = extractor.extract(crops).cpu().contiguous();
+        data.push_back(cv::Mat(int(feats.size(0)), int(feats.size(1)), CV_32F, feats.data_ptr<float>()).clone());
+        crops.clear();
+    };
+    cv::Mat image;
+    for (size_t i = 0; i < samples.size(); ++i) {
+        auto &s = samples[i];
+        if (i == 0 || s.seq != samples[i - 1].seq || s.frame != samples[i - 1].frame) {
+            image = read_frame(infos[s.seq], s.frame);
+        }
+        auto box = s.box & cv::Rect2f(0, 0, image.cols, image.rows);
+        if (box.width < 2 || box.height < 2) continue;
+        crops.push_back(image(box).clone());
+        if (crops.size() == batch_size) flush();
+    }
+    flush();
+    if (data.rows <= dims) {
+        throw runtime_error("Not enough crops to fit the projection");
+    }
+
+    cv::PCA pca(data, cv::noArray(), cv::PCA::DATA_AS_ROW, dims);
+
+    // share of the variance kept, against the total variance of the features
+    cv::Mat centered = data - cv::repeat(pca.mean, data.rows, 1);
+    auto total = cv::sum(centered.mul(centered))[0] / (data.rows - 1);
+    cout << data.rows << " crops, " << dims << " dimensions keep "
+         << cv::sum(pca.eigenvalues)[0] / total * 100 << "% of the variance" << endl;
+
+    // int32 input and output dimensions, the input mean, then the output x input matrix, row-major
+    ofstream out(out_path, ios_base::binary);
+    int32_t header[2] = {data.cols, dims};
+    out.write(reinterpret_cast<const char *>(header), sizeof(header));
+    out.write(reinterpret_cast<const char *>(pca.mean.ptr<float>()), data.cols * sizeof(float));
+    for (int r = 0; r < dims; ++r) {
+        out.write(reinterpret_cast<const char *>(pca.eigenvectors.ptr<float>(r)), data.cols * sizeof(float));
+    }
+}
@@ -0,0 +1,138 @@
+#include <algorithm>
+#include <unordered_map>
+
+#include "LAPJV.h"
+#include "metrics.h"
+
+using namespace std;
+
+MOTMetrics &MOTMetrics::operator+=(const MOTMetrics &o) {
+    gt += o.gt;
+    predicted += o.predicted;
+    matches += o.matches;
+    false_positives += o.false_positives;
+    misses += o.misses;
+    id_switches += o.id_switches;
+    fragmentations += o.fragmentations;
+    id_true_positives += o.id_true_positives;
+    iou_sum += o.iou_sum;
+    return *this;
+}
+
+namespace {
+    float iou(const cv::Rect2f &a, const cv::Rect2f &b) {
+        auto in = (a & b).area();
+        auto un = a.area() + b.area() - in;
+        return un > 0 ? in / un : 0;
+    }
+
+    // boxes grouped by frame, with ids renumbered densely
+    struct Frames {
+        vector<vector<pair<int, cv::Rect2f>>> boxes;
+        unordered_map<int, int> ids;
+        int64_t total = 0;
+
+        Frames(const vector<MOTBox> &in, bool drop_ignored) {
+            for (auto &b:in) {
+                if (b.frame < 1 || (drop_ignored && b.score == 0)) continue;
+                if (size_t(b.frame) > boxes.size()) {
+                    boxes.resize(b.frame);
+                }
+                auto id = ids.emplace(b.id, int(ids.size())).first->second;
+                boxes[b.frame - 1].emplace_back(id, b.box);
+                ++total;
+            }
+        }
+    };
+}
+
+MOTMetrics evaluate(const vector<MOTBox> &gt, const vector<MOTBox> &results, float iou_threshold) {
+    Frames g(gt, true), r(results, false);
+    auto n_frames = max(g.boxes.size(), r.boxes.size());
+    g.boxes.resize(n_frames);
+    r.boxes.resize(n_frames);
+
+    MOTMetrics m;
+    m.gt = g.total;
+    m.predicted = r.total;
+
+    // frame-by-frame matching of CLEAR MOT
+    const auto max_dist = 1 - iou_threshold;
+    vector<int> last_match(g.ids.size(), -1);   // tracker id last matched to each ground truth
+    vector<bool> tracked(g.ids.size(), false), lost(g.ids.size(), false);
+    CostMatrix id_overlap(g.ids.size(), r.ids.size(), 0);
+    LAPJV solver;
+    vector<int> row_to_col;
+    for (size_t f = 0; f < n_frames; ++f) {
+        auto &gf = g.boxes[f], &rf = r.boxes[f];
+        CostMatrix dist(gf.size(), rf.size(), INVALID_DIST);
+        for (size_t i = 0; i < gf.size(); ++i) {
+            for (size_t j = 0; j < rf.size(); ++j) {
+                auto o = iou(gf[i].second, rf[j].second);
+                if (o >= iou_threshold) {
+                    dist[i][j] = 1 - o;
+                    id_overlap[gf[i].first][rf[j].first] += 1;
+                }
+            }
+        }
+
+        // correspondences of the last frame are kept while they still overlap
+        vector<int> match(gf.size(), -1);
+        vector<bool> taken(rf.size(), false);
+        for (size_t i = 0; i < gf.size(); ++i) {
+            for (size_t j = 0; j < rf.size(); ++j) {
+                if (!taken[j] && rf[j].first == last_match[gf[i].first] && dist[i][j] <= max_dist) {
+                    match[i] = int(j);
+                    taken[j] = true;
+                    break;
+                }
+            }
+        }
+        for (size_t i = 0; i < gf.size(); ++i) {
+            for (size_t j = 0; j < rf.size(); ++j) {
+                if (match[i] != -1 || taken[j]) {
+                    dist[i][j] = INVALID_DIST;
+                }
+            }
+        }
+        solver.solve(dist.view(), max_dist, row_to_col);
+
+        int64_t frame_matches = 0;
+        for (size_t i = 0; i < gf.size(); ++i) {
+            auto gid = gf[i].first;
+            auto j = match[i] != -1 ? match[i] : row_to_col[i];
+            if (j == -1) {
+                ++m.misses;
+                lost[gid] = tracked[gid];
+                continue;
+            }
+            ++frame_matches;
+            m.iou_sum += iou(gf[i].second, rf[j].second);
+            if (last_match[gid] != -1 && last_match[gid] != rf[j].first) ++m.id_switches;
+            if (lost[gid]) ++m.fragmentations;
+            last_match[gid] = rf[j].first;
+            tracked[gid] = true;
+            lost[gid] = false;
+        }
+        m.matches += frame_matches;
+        m.false_positives += int64_t(rf.size()) - frame_matches;
+    }
+
+    // IDF1 maps whole trajectories one-to-one so as to maximize the frames they overlap.
+    // Leaving a ground truth unmapped costs as much as the longest overlap, so the minimum cost maximizes overlaps.
+    auto longest = 1.0f;
+    for (int64_t k = 0; k < id_overlap.size(); ++k) {
+        longest = max(longest, id_overlap.data()[k] + 1);
+    }
+    CostMatrix id_cost(id_overlap.rows(), id_overlap.cols());
+    for (int64_t k = 0; k < id_cost.size(); ++k) {
+        id_cost.data()[k] = longest - id_overlap.data()[k];
+    }
+    solver.solve(id_cost.view(), longest, row_to_col);
+    for (size_t i = 0; i < row_to_col.size(); ++i) {
+        if (row_to_col[i] != -1) {
+            m.id_true_positives += int64_t(id_overlap[i][row_to_col[i]]);
+        }
+    }
+    return m;
+}
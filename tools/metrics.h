@@ -0,0 +1,32 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <cstdint>
+#include <vector>
+
+#include "mot.h"
+
+// CLEAR MOT and identity metrics of tracking results against ground truth.
+// Counts add up over sequences, so one MOTMetrics can hold the total of a benchmark.
+struct MOTMetrics {
+    int64_t gt = 0, predicted = 0;
+    int64_t matches = 0, false_positives = 0, misses = 0;
+    int64_t id_switches = 0, fragmentations = 0;
+    int64_t id_true_positives = 0;  // boxes matched under the best one-to-one mapping of whole trajectories
+    double iou_sum = 0;
+
+    double mota() const { return gt ? 1 - double(misses + false_positives + id_switches) / gt : 0; }
+
+    double motp() const { return matches ? iou_sum / matches : 0; }
+
+    double idf1() const { return gt + predicted ? 2.0 * id_true_positives / (gt + predicted) : 0; }
+
+    MOTMetrics &operator+=(const MOTMetrics &o);
+};
+
+// Boxes match when their IoU is at least iou_threshold.
+// Ground truth with zero score is the "not considered" flag of MOTChallenge and is dropped,
+// tracker boxes overlapping it are not excused as the official evaluation does.
+MOTMetrics evaluate(const std::vector<MOTBox> &gt, const std::vector<MOTBox> &results, float iou_threshold = 0.5f);
+
+#endif //METRICS_H
@@ -0,0 +1,92 @@
+#include <experimental/filesystem>
+#include <algorithm>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+#include "mot.h"
+
+using namespace std;
+namespace fs = std::experimental::filesystem;
+
+vector<MOTBox> read_mot(const string &path) {
+    ifstream file(path);
+    if (!file) {
+        throw runtime_error("Cannot open " + path);
+    }
+
+    vector<MOTBox> boxes;
+    string line;
+    while (getline(file, line)) {
+        replace(line.begin(), line.end(), ',', ' ');
+        istringstream str(line);
+        MOTBox b{};
+        if (str >> b.frame >> b.id >> b.box.x >> b.box.y >> b.box.width >> b.box.height) {
+            if (!(str >> b.score)) b.score = 1;
+            boxes.push_back(b);
+        }
+    }
+    return boxes;
+}
+
+void write_mot(const string &path, const vector<MOTBox> &boxes) {
+    ofstream file(path);
+    file << fixed << setprecision(2);
+    for (auto &b:boxes) {
+        file << b.frame << ',' << b.id << ','
+           << b.box.x << ',' << b.box.y << ',' << b.box.width << ',' << b.box.height << ','
+           << b.score << ",-1,-1,-1\n";
+    }
+}
+
+vector<vector<cv::Rect2f>> boxes_by_frame(const vector<MOTBox> &boxes, const SequenceInfo &info, float min_score) {
+    // MOTChallenge detections often reach past the frame border
+    auto frame_box = cv::Rect2f(0, 0, info.dim[1], info.dim[0]);
+    vector<vector<cv::Rect2f>> out(info.n_frames);
+    for (auto &b:boxes) {
+        if (b.frame < 1 || b.score < min_score) continue;
+        auto box = b.box & frame_box;
+        if (box.empty()) continue;
+        if (size_t(b.frame) > out.size()) {
+            out.resize(b.frame);
+        }
+        out[b.frame - 1].push_back(box);
+    }
+    return out;
+}
+
+SequenceInfo read_seqinfo(const string &seq_dir) {
+    SequenceInfo info;
+    ifstream file(fs::path(seq_dir) / "seqinfo.ini");
+    string line;
+    while (getline(file, line)) {
+        if (!line.empty() && line.back() == '\r') line.pop_back();
+        auto eq = line.find('=');
+        if (eq == string::npos) continue;
+        auto key = line.substr(0, eq), value = line.substr(eq + 1);
+        if (key == "imDir") {
+            info.image_dir = (fs::path(seq_dir) / value).string();
+        } else if (key == "imExt") {
+            info.image_ext = value;
+        } else if (key == "imWidth") {
+            info.dim[1] = stoi(value);
+        } else if (key == "imHeight") {
+            info.dim[0] = stoi(value);
+        } else if (key == "seqLength") {
+            info.n_frames = stoi(value);
+        } else if (key == "frameRate") {
+            info.fps = stoi(value);
+        }
+    }
+    return info;
+}
+
+cv::Mat read_frame(const SequenceInfo &info, int frame) {
+    ostringstream name;
+    name << setw(6) << setfill('0') << frame << info.image_ext;
+    auto image = cv::imread((fs::path(info.image_dir) / name.str()).string());
+    if (image.empty()) {
+        throw runtime_error("Cannot read frame " + to_string(frame) + " from " + info.image_dir);
+    }
+    return image;
+}
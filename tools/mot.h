@@ -0,0 +1,40 @@
+#ifndef MOT_H
+#define MOT_H
+
+#include <array>
+#include <string>
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// One line of a MOTChallenge text file: "frame, id, left, top, width, height, score, ...".
+// Frames are numbered from 1 and detections have id -1.
+struct MOTBox {
+    int frame;
+    int id;
+    cv::Rect2f box;
+    float score;
+};
+
+std::vector<MOTBox> read_mot(const std::string &path);
+
+void write_mot(const std::string &path, const std::vector<MOTBox> &boxes);
+
+struct SequenceInfo {
+    std::array<int64_t, 2> dim{0, 0};
+    int n_frames = 0;
+    int fps = 0;
+    // directory and extension of the frame images, named %06d
+    std::string image_dir, image_ext = ".jpg";
+};
+
+// read the seqinfo.ini of a MOTChallenge sequence, fields that are missing stay empty
+SequenceInfo read_seqinfo(const std::string &seq_dir);
+
+cv::Mat read_frame(const SequenceInfo &info, int frame);
+
+// boxes[f] holds the boxes of frame f + 1 scoring at least min_score, clipped to the frame of info,
+// for info.n_frames frames or up to the last box. Boxes entirely outside the frame are dropped
+std::vector<std::vector<cv::Rect2f>> boxes_by_frame(const std::vector<MOTBox> &boxes, const SequenceInfo &info,
+                                                    float min_score = 0);
+
+#endif //MOT_H
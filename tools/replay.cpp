@@ -0,0 +1,108 @@
+// Replay recorded detections through SORT or DeepSORT as fast as possible and report timings.
+
+#include <experimental/filesystem>
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <iomanip>
+
+#include "mot.h"
+#include "run_tracker.h"
+
+using namespace std;
+namespace fs = std::experimental::filesystem;
+
+namespace {
+    const char *usage = "usage: replay <sequence dir> [--deepsort] [--appearance <full|ema|kmeans>]\n"
+                        "              [--association <optimal|greedy|auction>] [--budget <ms>]\n"
+                        "              [--det <det.txt>] [--min-score <score>] [--size <width>x<height>] [--log <per-frame csv>] [--out <results.txt>]";
+
+    double percentile(vector<double> v, double p) {
+        if (v.empty()) return 0;
+        auto k = static_cast<size_t>(p * (v.size() - 1));
+        nth_element(v.begin(), v.begin() + k, v.end());
+        return v[k];
+    }
+}
+
+int main(int argc, const char *argv[]) {
+    if (argc < 2) {
+        throw runtime_error(usage);
+    }
+    auto seq_dir = string(argv[1]);
+    auto det_path = (fs::path(seq_dir) / "det" / "det.txt").string();
+    auto use_deepsort = false;
+    DeepSORTOptions options;
+    auto min_score = 0.0f;
+    string log_path, out_path;
+
+    auto info = read_seqinfo(seq_dir);
+    for (int i = 2; i < argc; ++i) {
+        auto arg = string(argv[i]);
+        if (arg == "--deepsort") {
+            use_deepsort = true;
+        } else if (i + 1 < argc && arg == "--appearance") {
+            options.appearance = parse_appearance(argv[++i]);
+        } else if (i + 1 < argc && arg == "--association") {
+            options.association.mode = parse_association(argv[++i]);
+        } else if (i + 1 < argc && arg == "--budget") {
+            options.association.time_budget_ms = stod(argv[++i]);
+        } else if (i + 1 < argc && arg == "--det") {
+            det_path = argv[++i];
+        } else if (i + 1 < argc && arg == "--min-score") {
+            min_score = stof(argv[++i]);
+        } else if (i + 1 < argc && arg == "--size") {
+            auto size = string(argv[++i]);
+            auto x = size.find('x');
+            info.dim = {stoi(size.substr(x + 1)), stoi(size.substr(0, x))};
+        } else if (i + 1 < argc && arg == "--log") {
+            log_path = argv[++i];
+        } else if (i + 1 < argc && arg == "--out") {
+            out_path = argv[++i];
+        } else {
+            throw runtime_error(usage);
+        }
+    }
+    if (info.dim[0] <= 0 || info.dim[1] <= 0) {
+        throw runtime_error("Frame size is neither in seqinfo.ini nor given by --size");
+    }
+
+    auto run = run_tracker(info, boxes_by_frame(read_mot(det_path), info, min_score), use_deepsort,
+                           options);
+
+    if (!log_path.empty()) {
+        ofstream log(log_path);
+        log << "frame,latency_ms,association_ms,extraction_ms,detections,tracks\n";
+        for (size_t f = 0; f < run.frames.size(); ++f) {
+            auto &t = run.frames[f];
+            log << f + 1 << ',' << t.latency_ms << ',' << t.association_ms << ',' << t.extraction_ms << ','
+                << t.detections << ',' << t.tracks << '\n';
+        }
+    }
+    if (!out_path.empty()) {
+        write_mot(out_path, run.tracks);
+    }
+
+    vector<double> latencies;
+    size_t total_tracks = 0, max_tracks = 0;
+    for (auto &t:run.frames) {
+        latencies.push_back(t.latency_ms);
+        total_tracks += t.tracks;
+        max_tracks = max(max_tracks, t.tracks);
+    }
+    auto n = max<size_t>(run.frames.size(), 1);
+    cout << fixed << setprecision(3)
+         << "Frames: " << run.frames.size() << ", FPS: " << run.frames.size() / max(run.seconds(), 1e-9) << '\n'
+         << "Latency ms: p50 " << percentile(latencies, 0.5)
+         << ", p90 " << percentile(latencies, 0.9)
+         << ", p99 " << percentile(latencies, 0.99)
+         << ", max " << percentile(latencies, 1) << '\n'
+         << "Association ms/frame: " << run.stats.association_time * 1000 / n << '\n'
+         << "Extraction ms/frame: " << run.stats.extraction_time * 1000 / n << '\n'
+         << "Tracks: mean " << double(total_tracks) / n << ", max " << max_tracks << endl;
+    if (options.association.mode != AssociationMode::Optimal) {
+        auto &a = run.stats.assignment;
+        cout << "Assignments off optimal: " << a.deviating << " of " << a.checked << " checked"
+             << ", excess cost " << a.excess_cost << ", auctions over budget " << a.over_budget << endl;
+    }
+}
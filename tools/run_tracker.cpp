@@ -0,0 +1,80 @@
+#include <chrono>
+#include <functional>
+#include <memory>
+#include <stdexcept>
+
+#include "SORT.h"
+#include "DeepSORT.h"
+#include "run_tracker.h"
+
+using namespace std;
+
+double TrackerRun::seconds() const {
+    auto ms = 0.0;
+    for (auto &f:frames) {
+        ms += f.latency_ms;
+    }
+    return ms / 1000;
+}
+
+AppearanceModel parse_appearance(const string &name) {
+    if (name == "full") return AppearanceModel::Full;
+    if (name == "ema") return AppearanceModel::EMA;
+    if (name == "kmeans") return AppearanceModel::KMeans;
+    throw runtime_error("Unknown appearance model " + name);
+}
+
+AssociationMode parse_association(const string &name) {
+    if (name == "optimal") return AssociationMode::Optimal;
+    if (name == "greedy") return AssociationMode::Greedy;
+    if (name == "auction") return AssociationMode::Auction;
+    throw runtime_error("Unknown association mode " + name);
+}
+
+TrackerRun run_tracker(const SequenceInfo &info, const vector<vector<cv::Rect2f>> &dets, bool deepsort,
+                       const DeepSORTOptions &options) {
+    if (deepsort && info.image_dir.empty()) {
+        throw runtime_error("DeepSORT needs the frame images listed in seqinfo.ini");
+    }
+
+    // both trackers behind the same calls
+    unique_ptr<SORT> sort;
+    unique_ptr<DeepSORT> deep;
+    function<vector<Track>(const vector<cv::Rect2f> &, const cv::Mat &)> update;
+    function<TrackerStats()> stats;
+    function<size_t()> bytes;
+    if (deepsort) {
+        deep = make_unique<DeepSORT>(info.dim, options);
+        update = [&](const vector<cv::Rect2f> &d, const cv::Mat &image) { return deep->update(d, image); };
+        stats = [&] { return TrackerStats(deep->stats()); };
+        bytes = [&] { return deep->bytes(); };
+    } else {
+        sort = make_unique<SORT>(info.dim, nullptr, options.association);
+        update = [&](const vector<cv::Rect2f> &d, const cv::Mat &) { return sort->update(d); };
+        stats = [&] { return sort->stats(); };
+        bytes = [&] { return sort->bytes(); };
+    }
+
+    TrackerRun run;
+    for (size_t f = 0; f < dets.size(); ++f) {
+        auto frame = static_cast<int>(f + 1);
+        auto image = deepsort ? read_frame(info, frame) : cv::Mat();
+
+        auto before = stats();
+        auto start = chrono::steady_clock::now();
+        auto trks = update(dets[f], image);
+        auto latency = chrono::duration<double, milli>(chrono::steady_clock::now() - start).count();
+        auto after = stats();
+        run.peak_bytes = max(run.peak_bytes, bytes());
+
+        run.frames.push_back({latency,
+                              (after.association_time - before.association_time) * 1000,
+                              (after.extraction_time - before.extraction_time) * 1000,
+                              dets[f].size(), trks.size()});
+        for (auto &t:trks) {
+            run.tracks.push_back({frame, t.id + 1, t.box, 1});
+        }
+    }
+    run.stats = stats();
+    return run;
+}
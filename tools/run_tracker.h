@@ -0,0 +1,38 @@
+#ifndef RUN_TRACKER_H
+#define RUN_TRACKER_H
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "Track.h"
+#include "DeepSORT.h"
+#include "mot.h"
+
+struct FrameTiming {
+    double latency_ms, association_ms, extraction_ms;
+    size_t detections, tracks;
+};
+
+struct TrackerRun {
+    std::vector<MOTBox> tracks;  // MOTChallenge ids, starting from 1
+    std::vector<FrameTiming> frames;
+    TrackerStats stats;
+    // largest memory held by the tracker state after a frame
+    size_t peak_bytes = 0;
+
+    double seconds() const;
+};
+
+// Feed dets[f] to a new SORT or DeepSORT as frame f + 1, as fast as possible.
+// Frame images, needed by DeepSORT only, are read outside the timed region.
+// SORT takes options.association only.
+TrackerRun run_tracker(const SequenceInfo &info, const std::vector<std::vector<cv::Rect2f>> &dets, bool deepsort,
+                       const DeepSORTOptions &options = {});
+
+// "full", "ema" or "kmeans"
+AppearanceModel parse_appearance(const std::string &name);
+
+// "optimal", "greedy" or "auction"
+AssociationMode parse_association(const std::string &name);
+
+#endif //RUN_TRACKER_H
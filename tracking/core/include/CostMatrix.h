@@ -0,0 +1,112 @@
+#ifndef COST_MATRIX_H
+#define COST_MATRIX_H
+
+#include <vector>
+#include <cstdint>
+#include <algorithm>
+
+const float INVALID_DIST = 1E3f;
+
+// Read-only view of a cost matrix stored in a contiguous float buffer.
+// Strides are in elements, so a transposed view needs no copy.
+struct CostView {
+    const float *data;
+    int64_t rows, cols;
+    int64_t row_stride, col_stride;
+
+    CostView(const float *data, int64_t rows, int64_t cols)
+            : CostView(data, rows, cols, cols, 1) {}
+
+    CostView(const float *data, int64_t rows, int64_t cols, int64_t row_stride, int64_t col_stride)
+            : data(data), rows(rows), cols(cols), row_stride(row_stride), col_stride(col_stride) {}
+
+    float operator()(int64_t i, int64_t j) const { return data[i * row_stride + j * col_stride]; }
+
+    CostView t() const { return CostView(data, cols, rows, col_stride, row_stride); }
+};
+
+// valid pair of a sparse cost matrix
+struct CostEntry {
+    int row, col;
+    float cost;
+};
+
+// Track x detection cost matrix passed between metrics and the assignment.
+// It is either dense and row-major, or sparse: a list of pairs sorted by row then column,
+// every pair not listed being INVALID_DIST. Element access and view() are for dense matrices only.
+class CostMatrix {
+public:
+    CostMatrix() = default;
+
+    CostMatrix(int64_t rows, int64_t cols, float value = 0)
+            : _rows(rows), _cols(cols), buf(rows * cols, value) {}
+
+    // sparse matrix of the listed pairs, which must be unique
+    static CostMatrix sparse(int64_t rows, int64_t cols, std::vector<CostEntry> entries) {
+        CostMatrix m;
+        m._rows = rows;
+        m._cols = cols;
+        m._sparse = true;
+        std::sort(entries.begin(), entries.end(), [](const CostEntry &a, const CostEntry &b) {
+            return a.row != b.row ? a.row < b.row : a.col < b.col;
+        });
+        m._entries = std::move(entries);
+        return m;
+    }
+
+    int64_t rows() const { return _rows; }
+
+    int64_t cols() const { return _cols; }
+
+    int64_t size() const { return _rows * _cols; }
+
+    bool is_sparse() const { return _sparse; }
+
+    // listed pairs of a sparse matrix, some may have been gated to INVALID_DIST
+    const std::vector<CostEntry> &entries() const { return _entries; }
+
+    float *data() { return buf.data(); }
+
+    const float *data() const { return buf.data(); }
+
+    float *operator[](int64_t i) { return buf.data() + i * _cols; }
+
+    const float *operator[](int64_t i) const { return buf.data() + i * _cols; }
+
+    CostView view() const { return CostView(buf.data(), _rows, _cols); }
+
+    // call f(row, col, cost) on every entry below INVALID_DIST, row by row, where f may change the cost
+    template<typename F>
+    void for_each_valid(F f) {
+        if (_sparse) {
+            for (auto &e:_entries) {
+                if (e.cost < INVALID_DIST) f(e.row, e.col, e.cost);
+            }
+            return;
+        }
+        for (int64_t i = 0; i < _rows; ++i) {
+            auto row = (*this)[i];
+            for (int64_t j = 0; j < _cols; ++j) {
+                if (row[j] < INVALID_DIST) f(int(i), int(j), row[j]);
+            }
+        }
+    }
+
+    // replace entries above max_dist by INVALID_DIST
+    void gate(float max_dist) {
+        for (auto &d:buf) {
+            d = d > max_dist ? INVALID_DIST : d;
+        }
+        for (auto &e:_entries) {
+            e.cost = e.cost > max_dist ? INVALID_DIST : e.cost;
+        }
+    }
+
+private:
+    int64_t _rows = 0, _cols = 0;
+    std::vector<float> buf;
+    bool _sparse = false;
+    std::vector<CostEntry> _entries;
+};
+
+#endif //COST_MATRIX_H
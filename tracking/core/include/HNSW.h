@@ -0,0 +1,61 @@
+#ifndef HNSW_H
+#define HNSW_H
+
+#include <random>
+#include <utility>
+#include <vector>
+#include <cstdint>
+
+#include "tracking_core_export.h"
+
+// Hierarchical navigable small world graph (Malkov and Yashunin, 2018) for approximate nearest neighbour
+// search of unit vectors by cosine distance. Points can only be added.
+// Searching reuses a visited list, so one index must not be searched by several threads at once.
+class TRACKING_CORE_EXPORT HNSW {
+public:
+    // M links per point above the bottom layer and 2M in it, ef_* candidates kept while inserting and searching
+    explicit HNSW(int dim, int M = 16, int ef_construction = 100, int ef_search = 64);
+
+    // copy a unit vector into the index, return its index
+    int add(const float *point);
+
+    // up to k nearest points as (distance, index), nearest first
+    std::vector<std::pair<float, int>> search(const float *query, int k) const;
+
+    const float *point(int i) const { return data.data() + int64_t(i) * dim; }
+
+    size_t size() const { return levels.size(); }
+
+    // memory held by the points and their links
+    size_t bytes() const;
+
+private:
+    using Candidate = std::pair<float, int>;
+
+    float distance(const float *a, const float *b) const;
+
+    // ef nearest points to query on level, starting from entry, unordered
+    std::vector<Candidate> search_level(const float *query, const std::vector<Candidate> &entry,
+                                        int ef, int level) const;
+
+    // pick up to m neighbours among candidates, skipping those closer to a picked one than to the base
+    std::vector<int> select_neighbours(std::vector<Candidate> candidates, int m) const;
+
+    std::vector<int> &links(int i, int level) { return graph[i][level]; }
+
+    int dim, M, ef_construction, ef_search;
+    double level_mult;
+    std::mt19937 rng;
+
+    std::vector<float> data;
+    std::vector<int> levels;
+    // graph[i][l] are the neighbours of point i on level l
+    std::vector<std::vector<std::vector<int>>> graph;
+    int entry_point = -1;
+
+    // last search that visited each point
+    mutable std::vector<uint32_t> visited;
+    mutable uint32_t n_searches = 0;
+};
+
+#endif //HNSW_H
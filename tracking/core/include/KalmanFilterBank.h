@@ -0,0 +1,84 @@
+#ifndef KALMAN_FILTER_BANK_H
+#define KALMAN_FILTER_BANK_H
+
+#include <array>
+#include <vector>
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+
+#include "tracking_core_export.h"
+#include "Track.h"
+#include "Snapshot.h"
+
+// Constant velocity Kalman filters of all tracks, stored as structure-of-arrays indexed by track slot.
+// State is [cx,cy,s,r,vcx,vcy,vs] and measurement is [cx,cy,s,r].
+// Predict and correct are fixed-size kernels whose inner loops run across all slots,
+// free slots included, so that they never need compacting.
+// Noise is fixed as in SORT, or scales with the box as in DeepSORT.
+class TRACKING_CORE_EXPORT KalmanFilterBank {
+public:
+    static constexpr int state_dim = 7, measure_dim = 4;
+    static constexpr int innovation_size = measure_dim * (measure_dim + 1) / 2;
+
+    explicit KalmanFilterBank(MotionNoise noise = MotionNoise::Fixed) : noise(noise) {}
+
+    size_t size() const { return _rects.size(); }
+
+    // memory held by the bank
+    size_t bytes() const;
+
+    // (re)initialize the filter in slot t with the bounding box, growing the bank if needed
+    void init(int t, const cv::Rect2f &init_rect);
+
+    void predict();
+
+    // correct filter idx[i] with observed bounding box boxes[i]
+    void correct(const std::vector<int> &idx, const std::vector<cv::Rect2f> &boxes);
+
+    // innovation covariance S = H P H^T + R of filter t, upper triangle stored row by row
+    std::array<float, innovation_size> innovation_cov(size_t t) const;
+
+    // squared Mahalanobis distance between the predicted measurement of filter idx[i] and boxes[j],
+    // written to dist[i * boxes.size() + j]
+    void mahalanobis(const std::vector<int> &idx, const std::vector<cv::Rect2f> &boxes, float *dist) const;
+
+    // state and covariance of filter t
+    void save(size_t t, SnapshotWriter &out) const;
+
+    // overwrite filter t with a saved one, growing the bank if needed
+    void load(int t, SnapshotReader &in);
+
+    // bounding boxes of current states, refreshed after each predict/correct
+    const std::vector<cv::Rect2f> &rects() const { return _rects; }
+
+private:
+    // upper triangle of the symmetric covariance, stored row by row
+    static constexpr int cov_size = state_dim * (state_dim + 1) / 2;
+
+    static constexpr int sym(int i, int j) {
+        return i <= j ? i * state_dim - i * (i - 1) / 2 + (j - i) : sym(j, i);
+    }
+
+    void reserve(int t);
+
+    // variance of the measured [cx,cy,s,r] of filter t, scaled by its predicted box if noise is BoxScaled
+    std::array<float, measure_dim> measurement_noise(size_t t) const;
+
+    MotionNoise noise;
+
+    void update_rects(size_t begin, size_t end);
+
+    std::array<std::vector<float>, state_dim> x;
+    std::array<std::vector<float>, cov_size> P;
+
+    // process noise of each filter, staged by predict()
+    std::array<std::vector<float>, state_dim> q;
+
+    // measurements staged by correct(), masked by has_z
+    std::array<std::vector<float>, measure_dim> z;
+    std::vector<uint8_t> has_z;
+
+    std::vector<cv::Rect2f> _rects;
+};
+
+#endif //KALMAN_FILTER_BANK_H
@@ -0,0 +1,48 @@
+#ifndef KALMAN_H
+#define KALMAN_H
+
+#include "tracking_core_export.h"
+#include "Snapshot.h"
+
+enum class TrackState {
+    Tentative,
+    Confirmed,
+    Deleted
+};
+
+
+// This class represents the life cycle of individual tracked objects.
+// Their Kalman filters are kept together in KalmanFilterBank.
+class TRACKING_CORE_EXPORT KalmanTracker {
+public:
+    void predict();
+
+    // a track confirmed by this update takes next_id and increments it
+    void update(int &next_id);
+
+    void miss();
+
+    TrackState state() const { return _state; }
+
+    int id() const { return _id; }
+
+    // take over the ID of an earlier track of the same target
+    void recover_id(int id) { _id = id; }
+
+    void save(SnapshotWriter &out) const;
+
+    void load(SnapshotReader &in);
+
+private:
+    static const auto max_age = 30;
+    static const auto n_init = 3;
+
+    TrackState _state = TrackState::Tentative;
+
+    int _id = -1;
+
+    int time_since_update = 0;
+    int hits = 0;
+};
+
+#endif //KALMAN_H
@@ -0,0 +1,32 @@
+#ifndef LAPJV_H
+#define LAPJV_H
+
+#include <vector>
+
+#include "CostMatrix.h"
+#include "tracking_core_export.h"
+
+// Jonker-Volgenant style shortest augmenting path solver for rectangular assignment.
+// Every row may instead stay unassigned at cost_limit, so pairs costing more are never matched.
+// cost_limit must be finite.
+// Workspace is kept between calls to avoid reallocation every frame.
+class TRACKING_CORE_EXPORT LAPJV {
+public:
+    // row_to_col[i] is the column assigned to row i, or -1. Return the cost of assigned pairs.
+    // row_duals, if given, holds a dual for each row to start from, e.g. the ones of the same tracks in the last frame,
+    // and receives the final duals. Any starting values give the optimal assignment,
+    // but good ones leave most rows matched before the search.
+    float solve(const CostView &cost, float cost_limit, std::vector<int> &row_to_col, float *row_duals = nullptr);
+
+private:
+    // dual feasible partial assignment from the row duals in u
+    void warm_start(const CostView &cost, float cost_limit);
+
+    int augmenting_path(const CostView &cost, float cost_limit, int cur_row, float &min_val);
+
+    std::vector<float> u, v, shortest;
+    std::vector<int> path, col4row, row4col, remaining;
+    std::vector<int> scanned_rows, scanned_cols;
+};
+
+#endif //LAPJV_H
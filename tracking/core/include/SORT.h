@@ -0,0 +1,46 @@
+#ifndef SORT_H
+#define SORT_H
+
+#include <opencv2/opencv.hpp>
+#include <memory>
+#include <vector>
+
+#include "tracking_core_export.h"
+#include "Track.h"
+
+template<typename T>
+class TrackerManager;
+
+class TaskPool;
+
+class TRACKING_CORE_EXPORT SORT {
+public:
+    // pool, if given, must outlive the tracker
+    explicit SORT(const std::array<int64_t, 2> &dim, TaskPool *pool = nullptr,
+                  const AssociationOptions &association = {});
+
+    ~SORT();
+
+    std::vector<Track> update(const std::vector<cv::Rect2f> &dets);
+
+    const TrackerStats &stats() const { return _stats; }
+
+    // memory held by the tracker state
+    size_t bytes() const;
+
+    // Kalman states, track life cycles and the ID counter, to resume tracking in another process.
+    // Statistics are not included.
+    std::vector<uint8_t> snapshot() const;
+
+    // replace the state by a snapshot of a SORT with the same frame size, throw with the state unchanged if it is not one
+    void restore(const std::vector<uint8_t> &snapshot);
+
+private:
+    class TrackData;
+
+    TrackerStats _stats;
+
+    std::unique_ptr<TrackerManager<TrackData>> manager;
+};
+
+#endif //SORT_H
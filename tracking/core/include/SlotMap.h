@@ -0,0 +1,59 @@
+#ifndef SLOT_MAP_H
+#define SLOT_MAP_H
+
+#include <deque>
+#include <vector>
+
+// Slot map. Values live in stable slots that are reused through a free list,
+// so inserting and erasing never moves other values, and live slots are also kept in a dense list.
+// Slots are the handles: a slot is only valid until its value is erased
+template<typename T>
+class SlotMap {
+public:
+    // default-construct a value in a free slot, return the slot
+    int insert() {
+        int s;
+        if (free_slots.empty()) {
+            s = static_cast<int>(values.size());
+            values.emplace_back();
+            dense_pos.push_back(-1);
+        } else {
+            s = free_slots.back();
+            free_slots.pop_back();
+        }
+        dense_pos[s] = static_cast<int>(live.size());
+        live.push_back(s);
+        return s;
+    }
+
+    // erase the value in slot s, the last live slot takes its place in the dense list
+    void erase(int s) {
+        auto p = dense_pos[s];
+        live[p] = live.back();
+        dense_pos[live[p]] = p;
+        live.pop_back();
+        dense_pos[s] = -1;
+        values[s] = T();
+        free_slots.push_back(s);
+    }
+
+    T &operator[](int s) { return values[s]; }
+
+    const T &operator[](int s) const { return values[s]; }
+
+    bool contains(int s) const { return s >= 0 && size_t(s) < values.size() && dense_pos[s] != -1; }
+
+    // live slots in no particular order
+    const std::vector<int> &slots() const { return live; }
+
+    size_t size() const { return live.size(); }
+
+    // number of slots ever allocated, live or free
+    size_t capacity() const { return values.size(); }
+
+private:
+    std::deque<T> values;
+    std::vector<int> dense_pos, live, free_slots;
+};
+
+#endif //SLOT_MAP_H
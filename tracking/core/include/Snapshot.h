@@ -0,0 +1,66 @@
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+
+// Binary buffers for snapshots of tracker state.
+// Values are copied in native byte order, so a snapshot is restored on the same kind of machine.
+class SnapshotWriter {
+public:
+    template<typename T>
+    void put(const T &v) {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values go into snapshots");
+        write(&v, sizeof(v));
+    }
+
+    void write(const void *data, size_t n) {
+        auto bytes = static_cast<const uint8_t *>(data);
+        buf.insert(buf.end(), bytes, bytes + n);
+    }
+
+    std::vector<uint8_t> &data() { return buf; }
+
+private:
+    std::vector<uint8_t> buf;
+};
+
+class SnapshotReader {
+public:
+    explicit SnapshotReader(const std::vector<uint8_t> &buf) : buf(buf) {}
+
+    template<typename T>
+    T get() {
+        static_assert(std::is_trivially_copyable<T>::value, "only plain values come from snapshots");
+        T v;
+        read(&v, sizeof(v));
+        return v;
+    }
+
+    void read(void *data, size_t n) {
+        if (n > buf.size() - pos) {
+            throw std::runtime_error("Truncated tracker snapshot");
+        }
+        std::memcpy(data, buf.data() + pos, n);
+        pos += n;
+    }
+
+    // whether everything was read
+    bool at_end() const { return pos == buf.size(); }
+
+    // check the leading tag and version written by a tracker of the same kind
+    void expect(uint32_t tag, uint32_t version) {
+        if (get<uint32_t>() != tag || get<uint32_t>() != version) {
+            throw std::runtime_error("Snapshot is not from this kind of tracker or version");
+        }
+    }
+
+private:
+    const std::vector<uint8_t> &buf;
+    size_t pos = 0;
+};
+
+#endif //SNAPSHOT_H
@@ -0,0 +1,87 @@
+#ifndef SPARSE_ASSIGNMENT_H
+#define SPARSE_ASSIGNMENT_H
+
+#include <vector>
+#include <utility>
+#include <chrono>
+
+#include "tracking_core_export.h"
+#include "Track.h"
+#include "LAPJV.h"
+#include "TaskPool.h"
+
+// Assignment on a gated cost matrix, dense or sparse.
+// Pairs not exceeding cost_limit form a bipartite graph, which is split into connected components.
+// Components with a single row or column are resolved directly, the others are solved
+// independently by LAPJV, spread over the task pool when there is one and enough work.
+// In Greedy and Auction mode the components are solved approximately instead, and row duals are only
+// updated for the components resolved directly.
+class TRACKING_CORE_EXPORT SparseAssignment {
+public:
+    explicit SparseAssignment(TaskPool *pool = nullptr, const AssociationOptions &options = {})
+            : options(options), pool(pool) {}
+
+    // same contract as LAPJV::solve
+    void solve(const CostView &cost, float cost_limit, std::vector<int> &row_to_col, float *row_duals = nullptr);
+
+    // same, taking the pairs of a sparse matrix as they are
+    void solve(const CostMatrix &cost, float cost_limit, std::vector<int> &row_to_col, float *row_duals = nullptr);
+
+    const AssignmentStats &stats() const { return _stats; }
+
+private:
+    struct Worker {
+        LAPJV solver;
+        std::vector<float> sub_cost;
+        std::vector<int> sub_assignment;
+        std::vector<float> sub_duals;
+        // auction prices, column owners and the pairs of each row
+        std::vector<float> price;
+        std::vector<int> owner, queue, adj_offset;
+        std::vector<std::pair<int, float>> adj;
+        std::vector<int> sorted;
+        // optimal assignment of the component when checking
+        std::vector<int> exact;
+        double excess = 0;
+        int64_t over_budget = 0;
+    };
+
+    using Clock = std::chrono::steady_clock;
+
+    int find(int x);
+
+    // solve for the valid pairs in edges
+    void solve_edges(int nr, int nc, float cost_limit, std::vector<int> &row_to_col, float *row_duals);
+
+    void solve_component(Worker &w, int c, float cost_limit, std::vector<int> &row_to_col, float *row_duals,
+                         Clock::time_point deadline);
+
+    // assign the free rows and columns of component c to each other, cheapest pairs first
+    void greedy(Worker &w, int c);
+
+    // auction of the rows of component c for its columns, false if stopped by the deadline
+    bool auction(Worker &w, int c, float cost_limit, Clock::time_point deadline);
+
+    // rows are nodes [0, rows), columns are nodes [rows, rows + cols)
+    std::vector<int> parent;
+    std::vector<CostEntry> edges;
+
+    // nodes and edges grouped by component, indexed by the offsets
+    std::vector<int> comp_of_node, comp_rows, node_offset, nodes, edge_offset, comp_edges;
+
+    // index of a node among the rows or the columns of its component
+    std::vector<int> local;
+    int n_rows = 0;
+
+    AssociationOptions options;
+    AssignmentStats _stats;
+    int64_t n_solves = 0;
+    // whether the current approximate assignment is compared to the optimal one
+    bool checking = false;
+
+    TaskPool *pool;
+    // scratch space of each pool lane
+    std::vector<Worker> workers;
+};
+
+#endif //SPARSE_ASSIGNMENT_H
@@ -0,0 +1,58 @@
+#ifndef TASK_POOL_H
+#define TASK_POOL_H
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include "tracking_core_export.h"
+
+// Work-stealing thread pool.
+// Every worker owns a queue: tasks it submits go to the back of its own queue and it runs them from
+// the back, so follow-up work stays on the same core, while idle workers steal from the front of others.
+class TRACKING_CORE_EXPORT TaskPool {
+public:
+    explicit TaskPool(size_t n_threads = std::thread::hardware_concurrency());
+
+    ~TaskPool();
+
+    void submit(std::function<void()> task);
+
+    // Run f(i, lane) for i in [0, n) on the caller and idle workers, return when all are done.
+    // Within one call, f never runs twice at once with the same lane, so lane can index per-runner scratch space
+    // owned by the caller. Concurrent and nested calls are separate: each runs lane 0 on its own caller at the same time.
+    void parallel_for(size_t n, const std::function<void(size_t i, size_t lane)> &f);
+
+    // number of distinct lanes passed by parallel_for
+    size_t lanes() const { return threads.size() + 1; }
+
+    // block until every submitted task has finished
+    void wait();
+
+private:
+    struct Queue {
+        std::mutex mutex;
+        std::deque<std::function<void()>> tasks;
+    };
+
+    bool try_run(size_t self);
+
+    void work(size_t self);
+
+    std::vector<std::unique_ptr<Queue>> queues;
+    std::vector<std::thread> threads;
+
+    // queued tasks, changed under mutex, and tasks queued or running
+    std::atomic<size_t> pending{0}, unfinished{0};
+    std::atomic<size_t> next_queue{0};
+    bool stop = false;
+    std::mutex mutex;
+    std::condition_variable wake, idle;
+};
+
+#endif //TASK_POOL_H
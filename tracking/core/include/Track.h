@@ -0,0 +1,65 @@
+#ifndef DEFINES_H
+#define DEFINES_H
+
+#include <cstdint>
+#include <opencv2/opencv.hpp>
+
+struct Track {
+    int id;
+    cv::Rect2f box;
+};
+
+// Noise of the Kalman filters of the tracks
+enum class MotionNoise : uint8_t {
+    // constant variances, as in SORT
+    Fixed,
+    // standard deviations proportional to the box size, as in DeepSORT,
+    // so that Mahalanobis distances are comparable between near and far targets
+    BoxScaled
+};
+
+// How detections are assigned to tracks
+enum class AssociationMode : uint8_t {
+    // minimum total cost, by LAPJV
+    Optimal,
+    // cheapest pairs first, for crowds where the optimal assignment takes too long
+    Greedy,
+    // auction stopped by a time budget, the rows it leaves are matched greedily
+    Auction
+};
+
+struct AssociationOptions {
+    AssociationMode mode = AssociationMode::Optimal;
+    // time an assignment may spend in auctions, in milliseconds
+    double time_budget_ms = 1;
+    // final bid increment of the auction, a finished auction costs at most epsilon per track above optimal
+    float epsilon = 1e-3f;
+    // in Greedy and Auction mode, every check_interval-th assignment is also solved optimally
+    // to measure the deviation, 0 never checks
+    int check_interval = 50;
+};
+
+// how Greedy and Auction mode compare to the optimal assignment
+struct AssignmentStats {
+    // assignments also solved optimally
+    int64_t checked = 0;
+    // checked assignments costing more than the optimal one
+    int64_t deviating = 0;
+    // total cost above optimal of the checked assignments
+    double excess_cost = 0;
+    // auctions stopped by the time budget
+    int64_t over_budget = 0;
+};
+
+// accumulated by a tracker over all its updates
+struct TrackerStats {
+    int64_t frames = 0;
+    // seconds spent associating detections to tracks, appearance extraction excluded
+    double association_time = 0;
+    // seconds spent extracting appearance features
+    double extraction_time = 0;
+    AssignmentStats assignment;
+};
+
+
+#endif //DEFINES_H
@@ -0,0 +1,258 @@
+#ifndef TRACKER_H
+#define TRACKER_H
+
+#include <array>
+#include <vector>
+#include <tuple>
+#include <functional>
+#include <numeric>
+#include <cmath>
+
+#include "tracking_core_export.h"
+#include "Track.h"
+#include "KalmanTracker.h"
+#include "CostMatrix.h"
+#include "KalmanFilterBank.h"
+#include "SparseAssignment.h"
+#include "SlotMap.h"
+#include "Snapshot.h"
+
+using DistanceMetricFunc = std::function<
+        CostMatrix(const std::vector<int> &trk_ids, const std::vector<int> &det_ids)>;
+
+TRACKING_CORE_EXPORT void associate_detections_to_trackers_idx(const DistanceMetricFunc &metric,
+                                                               SparseAssignment &solver,
+                                                               std::vector<int> &unmatched_trks,
+                                                               std::vector<int> &unmatched_dets,
+                                                               std::vector<std::tuple<int, int>> &matched,
+                                                               std::vector<float> &duals);
+
+template<typename TrackData>
+class TrackerManager {
+public:
+    using RemoveFunc = std::function<void(TrackData &)>;
+
+    // on_remove is called on each track before it is erased, pool runs the assignment if given
+    explicit TrackerManager(const std::array<int64_t, 2> &dim, RemoveFunc on_remove = nullptr,
+                            TaskPool *pool = nullptr, const AssociationOptions &association = {},
+                            MotionNoise noise = MotionNoise::Fixed)
+            : kf(noise), solver(pool, association), img_box(0, 0, dim[1], dim[0]), on_remove(std::move(on_remove)) {}
+
+    // track in a slot, slots stay valid until the track is removed
+    TrackData &track(int slot) { return tracks[slot]; }
+
+    // slots of live tracks
+    const std::vector<int> &slots() const { return tracks.slots(); }
+
+    void predict() {
+        for (auto s:tracks.slots()) {
+            tracks[s].kalman.predict();
+        }
+        kf.predict();
+    }
+
+    void remove_nan() {
+        remove_if([this](int s) {
+            auto bbox = kf.rects()[s];
+            return std::isnan(bbox.x) || std::isnan(bbox.y) || std::isnan(bbox.width) || std::isnan(bbox.height);
+        });
+    }
+
+    void remove_deleted() {
+        remove_if([this](int s) { return tracks[s].kalman.state() == TrackState::Deleted; });
+    }
+
+    // deviation of an approximate association from the optimal one
+    const AssignmentStats &assignment_stats() const { return solver.stats(); }
+
+    // memory held by the tracks, their filters and their duals
+    size_t bytes() const {
+        auto n = tracks.capacity() * sizeof(TrackData) + kf.bytes();
+        for (auto &d:duals) n += d.capacity() * sizeof(float);
+        return n;
+    }
+
+    // predicted or corrected bounding boxes, indexed by slot
+    const std::vector<cv::Rect2f> &rects() const { return kf.rects(); }
+
+    // invalidate the valid pairs of cost whose squared Mahalanobis distance between the detection in dets
+    // and the predicted measurement of the track in trk_ids exceeds max_dist
+    void gate_mahalanobis(const std::vector<int> &trk_ids, const std::vector<cv::Rect2f> &dets,
+                          CostMatrix &cost, float max_dist) const {
+        // valid pairs come row by row, each row is one filter against its own detections
+        std::vector<cv::Rect2f> boxes;
+        std::vector<float *> costs;
+        std::vector<float> dist;
+        int row = -1;
+        auto flush = [&] {
+            if (boxes.empty()) return;
+            dist.resize(boxes.size());
+            kf.mahalanobis({trk_ids[row]}, boxes, dist.data());
+            for (size_t k = 0; k < boxes.size(); ++k) {
+                if (dist[k] > max_dist) *costs[k] = INVALID_DIST;
+            }
+            boxes.clear();
+            costs.clear();
+        };
+        cost.for_each_valid([&](int i, int j, float &c) {
+            if (i != row) {
+                flush();
+                row = i;
+            }
+            boxes.push_back(dets[j]);
+            costs.push_back(&c);
+        });
+        flush();
+    }
+
+    // return (track slot, detection index) pairs, including the tracks created for unmatched detections
+    std::vector<std::tuple<int, int>>
+    update(const std::vector<cv::Rect2f> &dets,
+           const DistanceMetricFunc &confirmed_metric, const DistanceMetricFunc &unconfirmed_metric) {
+        std::vector<int> unmatched_trks;
+        for (auto s:tracks.slots()) {
+            if (tracks[s].kalman.state() == TrackState::Confirmed) {
+                unmatched_trks.emplace_back(s);
+            }
+        }
+
+        std::vector<int> unmatched_dets(dets.size());
+        iota(unmatched_dets.begin(), unmatched_dets.end(), 0);
+
+        std::vector<std::tuple<int, int>> matched;
+
+        associate_detections_to_trackers_idx(confirmed_metric, solver, unmatched_trks, unmatched_dets, matched,
+                                             duals[0]);
+
+        for (auto s:tracks.slots()) {
+            if (tracks[s].kalman.state() == TrackState::Tentative) {
+                unmatched_trks.emplace_back(s);
+            }
+        }
+
+        associate_detections_to_trackers_idx(unconfirmed_metric, solver, unmatched_trks, unmatched_dets, matched,
+                                             duals[1]);
+
+        for (auto s : unmatched_trks) {
+            tracks[s].kalman.miss();
+        }
+
+        // update matched trackers with assigned detections.
+        // each prediction is corresponding to a manager
+        std::vector<int> idx;
+        std::vector<cv::Rect2f> boxes;
+        for (auto[x, y] : matched) {
+            tracks[x].kalman.update(next_id);
+            idx.emplace_back(x);
+            boxes.emplace_back(dets[y]);
+        }
+        kf.correct(idx, boxes);
+
+        // create and initialise new trackers for unmatched detections
+        for (auto umd : unmatched_dets) {
+            auto s = insert();
+            kf.init(s, dets[umd]);
+            matched.emplace_back(s, umd);
+        }
+
+        return matched;
+    }
+
+    std::vector<Track> visible_tracks() {
+        std::vector<Track> ret;
+        for (auto s:tracks.slots()) {
+            auto &t = tracks[s];
+            auto bbox = kf.rects()[s];
+            if (t.kalman.state() == TrackState::Confirmed &&
+                img_box.contains(bbox.tl()) && img_box.contains(bbox.br())) {
+                Track res{t.kalman.id(), bbox};
+                ret.push_back(res);
+            }
+        }
+        return ret;
+    }
+
+    // write the ID counter and live tracks, save_data writes what TrackData holds beyond kalman
+    template<typename SaveData>
+    void save(SnapshotWriter &out, SaveData save_data) const {
+        out.put(img_box.width);
+        out.put(img_box.height);
+        out.put(next_id);
+        out.put(uint32_t(tracks.size()));
+        for (auto s:tracks.slots()) {
+            tracks[s].kalman.save(out);
+            kf.save(s, out);
+            save_data(tracks[s], out);
+        }
+    }
+
+    // replace all tracks by saved ones, which get new slots. A bad snapshot throws with part of it loaded,
+    // so callers restore into a new manager and swap_tracks once everything is read
+    template<typename LoadData>
+    void load(SnapshotReader &in, LoadData load_data) {
+        auto width = in.get<float>(), height = in.get<float>();
+        if (width != img_box.width || height != img_box.height) {
+            throw std::runtime_error("Snapshot is from a tracker of another frame size");
+        }
+        remove_if([](int) { return true; });
+
+        next_id = in.get<int>();
+        for (auto n = in.get<uint32_t>(); n > 0; --n) {
+            auto s = insert();
+            tracks[s].kalman.load(in);
+            kf.load(s, in);
+            load_data(tracks[s], in);
+        }
+    }
+
+    // frame size the manager was made for, as {height, width}
+    std::array<int64_t, 2> dim() const {
+        return {int64_t(img_box.height), int64_t(img_box.width)};
+    }
+
+    // exchange the tracks, their filters and duals and the ID counter with other, without calling on_remove
+    void swap_tracks(TrackerManager &other) {
+        std::swap(tracks, other.tracks);
+        std::swap(kf, other.kf);
+        std::swap(next_id, other.next_id);
+        std::swap(duals, other.duals);
+    }
+
+private:
+    // a new track starts its assignment duals cold
+    int insert() {
+        auto s = tracks.insert();
+        for (auto &d:duals) {
+            d.resize(tracks.capacity());
+            d[s] = 0;
+        }
+        return s;
+    }
+
+    // erase the tracks whose slot satisfies pred, their filters are simply left unused
+    template<typename Pred>
+    void remove_if(Pred pred) {
+        // backwards, as erasing moves the last live slot into the current position
+        auto &live = tracks.slots();
+        for (auto p = live.size(); p-- > 0;) {
+            auto s = live[p];
+            if (pred(s)) {
+                if (on_remove) on_remove(tracks[s]);
+                tracks.erase(s);
+            }
+        }
+    }
+
+    SlotMap<TrackData> tracks;
+    KalmanFilterBank kf;
+    // IDs are given out per tracker, in order of confirmation
+    int next_id = 0;
+    SparseAssignment solver;
+    // dual of each track slot in the last assignment of the confirmed and of the unconfirmed stage,
+    // which warm-starts the next one. Detections are new every frame, so the duals are what carries over
+    std::array<std::vector<float>, 2> duals;
+    const cv::Rect2f img_box;
+    RemoveFunc on_remove;
+};
+
+#endif //TRACKER_H
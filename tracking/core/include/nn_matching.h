@@ -0,0 +1,38 @@
+#ifndef NN_MATCHING_H
+#define NN_MATCHING_H
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+#include "tracking_core_export.h"
+#include "CostMatrix.h"
+
+// bounding boxes as structure-of-arrays for the IoU kernel
+struct TRACKING_CORE_EXPORT BoxArray {
+    std::vector<float> x1, y1, x2, y2, area;
+
+    BoxArray() = default;
+
+    explicit BoxArray(const std::vector<cv::Rect2f> &rects);
+
+    void push_back(const cv::Rect2f &rect);
+
+    size_t size() const { return x1.size(); }
+};
+
+// write 1 - IoU of every track against every detection into the row-major buffer dist,
+// distances above max_dist are replaced by INVALID_DIST in the same pass
+TRACKING_CORE_EXPORT void iou_dist(const BoxArray &trks, const BoxArray &dets, float max_dist, float *dist);
+
+// same for the candidate pairs (trk_idx[k], det_idx[k]), written to dist[k]
+TRACKING_CORE_EXPORT void iou_dist(const BoxArray &trks, const BoxArray &dets,
+                                   const std::vector<int> &trk_idx, const std::vector<int> &det_idx,
+                                   float max_dist, float *dist);
+
+// track x detection IoU distances. When max_dist < 1 only overlapping boxes can be valid,
+// so large problems only evaluate the pairs listed by a spatial grid over the tracks,
+// and return a sparse matrix of the valid ones.
+TRACKING_CORE_EXPORT CostMatrix iou_dist(const std::vector<cv::Rect2f> &dets, const std::vector<cv::Rect2f> &trks,
+                                         float max_dist = 1.0f);
+
+#endif //NN_MATCHING_H
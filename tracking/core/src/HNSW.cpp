@@ -0,0 +1,161 @@
+#include <cmath>
+#include <queue>
+#include <algorithm>
+#include <functional>
+
+#include "HNSW.h"
+
+using namespace std;
+
+namespace {
+    const int lanes = 16;
+}
+
+HNSW::HNSW(int dim, int M, int ef_construction, int ef_search)
+        : dim(dim), M(M), ef_construction(ef_construction), ef_search(ef_search),
+          level_mult(1 / log(double(M))) {}
+
+size_t HNSW::bytes() const {
+    auto n = data.capacity() * sizeof(float) + levels.capacity() * sizeof(int) + visited.capacity() * sizeof(uint32_t);
+    for (auto &point:graph) {
+        n += point.capacity() * sizeof(vector<int>);
+        for (auto &l:point) n += l.capacity() * sizeof(int);
+    }
+    return n;
+}
+
+float HNSW::distance(const float *a, const float *b) const {
+    // independent partial sums, so that the compiler may vectorize without reassociating
+    float acc[lanes] = {};
+    int k = 0;
+    for (; k + lanes <= dim; k += lanes) {
+        for (int l = 0; l < lanes; ++l) {
+            acc[l] += a[k + l] * b[k + l];
+        }
+    }
+    auto dot = 0.0f;
+    for (; k < dim; ++k) {
+        dot += a[k] * b[k];
+    }
+    for (auto v:acc) {
+        dot += v;
+    }
+    return 1 - dot;
+}
+
+vector<HNSW::Candidate> HNSW::search_level(const float *query, const vector<Candidate> &entry,
+                                           int ef, int level) const {
+    if (visited.size() < size()) {
+        visited.resize(size(), 0);
+    }
+    if (++n_searches == 0) {
+        fill(visited.begin(), visited.end(), 0);
+        n_searches = 1;
+    }
+
+    // candidates to expand, nearest on top, and the ef nearest found, farthest on top
+    priority_queue<Candidate, vector<Candidate>, greater<>> candidates;
+    priority_queue<Candidate> found;
+    for (auto &e:entry) {
+        visited[e.second] = n_searches;
+        candidates.push(e);
+        found.push(e);
+    }
+    while (found.size() > size_t(ef)) found.pop();
+
+    while (!candidates.empty()) {
+        auto c = candidates.top();
+        if (c.first > found.top().first) break;
+        candidates.pop();
+
+        for (auto n:graph[c.second][level]) {
+            if (visited[n] == n_searches) continue;
+            visited[n] = n_searches;
+
+            auto d = distance(query, point(n));
+            if (found.size() < size_t(ef) || d < found.top().first) {
+                candidates.emplace(d, n);
+                found.emplace(d, n);
+                if (found.size() > size_t(ef)) found.pop();
+            }
+        }
+    }
+
+    vector<Candidate> out;
+    out.reserve(found.size());
+    for (; !found.empty(); found.pop()) {
+        out.push_back(found.top());
+    }
+    return out;
+}
+
+vector<int> HNSW::select_neighbours(vector<Candidate> candidates, int m) const {
+    sort(candidates.begin(), candidates.end());
+    vector<int> picked;
+    for (auto &c:candidates) {
+        if (picked.size() == size_t(m)) break;
+        auto keep = all_of(picked.begin(), picked.end(), [&](int p) {
+            return distance(point(c.second), point(p)) >= c.first;
+        });
+        if (keep) picked.push_back(c.second);
+    }
+    return picked;
+}
+
+int HNSW::add(const float *p) {
+    auto i = static_cast<int>(size());
+    auto level = static_cast<int>(-log(uniform_real_distribution<double>(1e-9, 1)(rng)) * level_mult);
+    data.insert(data.end(), p, p + dim);
+    levels.push_back(level);
+    graph.emplace_back(level + 1);
+    if (entry_point == -1) {
+        entry_point = i;
+        return i;
+    }
+
+    // greedy descent through the levels above the new point
+    auto q = point(i);
+    vector<Candidate> entry{{distance(q, point(entry_point)), entry_point}};
+    for (auto l = levels[entry_point]; l > level; --l) {
+        entry = search_level(q, entry, 1, l);
+    }
+
+    for (auto l = min(level, levels[entry_point]); l >= 0; --l) {
+        entry = search_level(q, entry, ef_construction, l);
+        auto max_links = l == 0 ? 2 * M : M;
+        links(i, l) = select_neighbours(entry, M);
+
+        // link back, pruning neighbours that went over the limit
+        for (auto n:links(i, l)) {
+            auto &back = links(n, l);
+            back.push_back(i);
+            if (back.size() > size_t(max_links)) {
+                vector<Candidate> c;
+                for (auto b:back) {
+                    c.emplace_back(distance(point(n), point(b)), b);
+                }
+                back = select_neighbours(move(c), max_links);
+            }
+        }
+    }
+
+    if (level > levels[entry_point]) {
+        entry_point = i;
+    }
+    return i;
+}
+
+vector<pair<float, int>> HNSW::search(const float *query, int k) const {
+    if (entry_point == -1) return {};
+
+    vector<Candidate> entry{{distance(query, point(entry_point)), entry_point}};
+    for (auto l = levels[entry_point]; l > 0; --l) {
+        entry = search_level(query, entry, 1, l);
+    }
+    auto found = search_level(query, entry, max(ef_search, k), 0);
+    sort(found.begin(), found.end());
+    if (found.size() > size_t(k)) {
+        found.resize(k);
+    }
+    return found;
+}
@@ -0,0 +1,321 @@
+#include <cmath>
+#include <algorithm>
+
+#include "KalmanFilterBank.h"
+
+using namespace std;
+
+namespace {
+    // noise as in SORT
+    const float fixed_process_noise = 1e-2f;
+    const float fixed_measurement_noise = 1e-1f;
+    const float fixed_initial_cov = 1.0f;
+
+    // noise as in DeepSORT, standard deviations relative to the box height for the center,
+    // and to the area for the area, so that the filter behaves the same for near and far targets
+    const float std_weight_position = 1.0f / 20;
+    const float std_weight_velocity = 1.0f / 160;
+    // aspect ratio is scale-free
+    const float std_aspect_measure = 1e-1f, std_aspect_process = 1e-2f;
+
+    const size_t lanes = 8;
+
+    float height(float s, float r) {
+        return s > 0 && r > 0 ? sqrt(s / r) : 1.0f;
+    }
+
+    // variance of each state entry with standard deviation weights w_pos and w_vel of a box of area s and height h,
+    // the aspect ratio and its velocity get std_aspect
+    array<float, KalmanFilterBank::state_dim> scaled_noise(float s, float h, float w_pos, float w_vel,
+                                                           float std_aspect) {
+        auto sq = [](float v) { return v * v; };
+        return {sq(w_pos * h), sq(w_pos * h), sq(2 * w_pos * s), sq(std_aspect),
+                sq(w_vel * h), sq(w_vel * h), sq(2 * w_vel * s)};
+    }
+
+    // Convert bounding box from [x,y,w,h] to [cx,cy,s,r] style.
+    array<float, KalmanFilterBank::measure_dim> get_xysr(const cv::Rect2f &rect) {
+        return {rect.x + rect.width / 2, rect.y + rect.height / 2, rect.area(), rect.width / rect.height};
+    }
+}
+
+void KalmanFilterBank::reserve(int t) {
+    if (size_t(t) >= size()) {
+        for (auto &v:x) v.resize(t + 1);
+        for (auto &v:P) v.resize(t + 1);
+        _rects.resize(t + 1);
+    }
+}
+
+size_t KalmanFilterBank::bytes() const {
+    auto n = has_z.capacity() + _rects.capacity() * sizeof(cv::Rect2f);
+    for (auto &v:x) n += v.capacity() * sizeof(float);
+    for (auto &v:P) n += v.capacity() * sizeof(float);
+    for (auto &v:z) n += v.capacity() * sizeof(float);
+    for (auto &v:q) n += v.capacity() * sizeof(float);
+    return n;
+}
+
+void KalmanFilterBank::init(int t, const cv::Rect2f &init_rect) {
+    reserve(t);
+
+    auto xysr = get_xysr(init_rect);
+    for (int i = 0; i < state_dim; ++i) {
+        x[i][t] = i < measure_dim ? xysr[i] : 0;
+    }
+    // a new track is unsure of its position and knows nothing of its velocity
+    array<float, state_dim> p0;
+    if (noise == MotionNoise::BoxScaled) {
+        p0 = scaled_noise(xysr[2], init_rect.height, 2 * std_weight_position, 10 * std_weight_velocity,
+                          std_aspect_process);
+    } else {
+        p0.fill(fixed_initial_cov);
+    }
+    for (int i = 0; i < state_dim; ++i) {
+        for (int j = i; j < state_dim; ++j) {
+            P[sym(i, j)][t] = i == j ? p0[i] : 0;
+        }
+    }
+    update_rects(t, t + 1);
+}
+
+void KalmanFilterBank::save(size_t t, SnapshotWriter &out) const {
+    for (auto &v:x) out.put(v[t]);
+    for (auto &v:P) out.put(v[t]);
+}
+
+void KalmanFilterBank::load(int t, SnapshotReader &in) {
+    reserve(t);
+    for (auto &v:x) v[t] = in.get<float>();
+    for (auto &v:P) v[t] = in.get<float>();
+    update_rects(t, t + 1);
+}
+
+void KalmanFilterBank::predict() {
+    const auto n = size();
+
+    // process noise of the box before the motion
+    for (auto &v:q) v.resize(n);
+    if (noise == MotionNoise::BoxScaled) {
+        for (size_t t = 0; t < n; ++t) {
+            auto v = scaled_noise(x[2][t], height(x[2][t], x[3][t]), std_weight_position, std_weight_velocity,
+                             std_aspect_process);
+            for (int i = 0; i < state_dim; ++i) q[i][t] = v[i];
+        }
+    } else {
+        for (auto &v:q) fill(v.begin(), v.end(), fixed_process_noise);
+    }
+
+    // x = F x, F adds velocity of [cx,cy,s] to themselves
+    for (int k = 0; k < 3; ++k) {
+        auto pos = x[k].data();
+        auto vel = x[k + 4].data();
+        for (size_t t = 0; t < n; ++t) {
+            pos[t] += vel[t];
+        }
+    }
+
+    // P = F P F^T + Q, entry by entry
+    // P(i,j) only reads entries after itself in row-major order, so it can be updated in place
+    for (int i = 0; i < state_dim; ++i) {
+        for (int j = i; j < state_dim; ++j) {
+            auto p = P[sym(i, j)].data();
+            if (i < 3) {
+                auto a = P[sym(i + 4, j)].data();
+                for (size_t t = 0; t < n; ++t) p[t] += a[t];
+            }
+            if (j < 3) {
+                auto a = P[sym(i, j + 4)].data();
+                for (size_t t = 0; t < n; ++t) p[t] += a[t];
+            }
+            if (i < 3 && j < 3) {
+                auto a = P[sym(i + 4, j + 4)].data();
+                for (size_t t = 0; t < n; ++t) p[t] += a[t];
+            }
+            if (i == j) {
+                auto a = q[i].data();
+                for (size_t t = 0; t < n; ++t) p[t] += a[t];
+            }
+        }
+    }
+
+    update_rects(0, size());
+}
+
+void KalmanFilterBank::correct(const vector<int> &idx, const vector<cv::Rect2f> &boxes) {
+    const auto n = size();
+
+    // stage measurements densely so the kernel runs over all tracks with a mask
+    for (auto &v:z) v.assign(n, 0);
+    has_z.assign(n, 0);
+    for (size_t i = 0; i < idx.size(); ++i) {
+        auto xysr = get_xysr(boxes[i]);
+        for (int a = 0; a < measure_dim; ++a) {
+            z[a][idx[i]] = xysr[a];
+        }
+        has_z[idx[i]] = 1;
+    }
+
+    // tracks are processed in blocks, with the lane loop innermost so that it vectorizes
+    for (size_t t0 = 0; t0 < n; t0 += lanes) {
+        const auto len = min(lanes, n - t0);
+
+        // B = H P, S = H P H^T + R, y = z - H x
+        float B[measure_dim][state_dim][lanes] = {}, y[measure_dim][lanes] = {};
+        bool m[lanes] = {};
+        for (int a = 0; a < measure_dim; ++a) {
+            for (int c = 0; c < state_dim; ++c) {
+                copy_n(&P[sym(a, c)][t0], len, B[a][c]);
+            }
+            for (size_t l = 0; l < len; ++l) y[a][l] = z[a][t0 + l] - x[a][t0 + l];
+        }
+        copy_n(&has_z[t0], len, m);
+
+        // measurement noise of the predicted boxes, padding lanes get any positive value
+        float R[measure_dim][lanes];
+        for (size_t l = 0; l < lanes; ++l) {
+            auto r = l < len ? measurement_noise(t0 + l) : array<float, measure_dim>{1, 1, 1, 1};
+            for (int a = 0; a < measure_dim; ++a) R[a][l] = r[a];
+        }
+
+        // S = L D L^T with unit lower triangular L
+        float L[measure_dim][measure_dim][lanes] = {}, D[measure_dim][lanes];
+        for (int a = 0; a < measure_dim; ++a) {
+            for (size_t l = 0; l < lanes; ++l) D[a][l] = B[a][a][l] + R[a][l];
+            for (int k = 0; k < a; ++k) {
+                for (size_t l = 0; l < lanes; ++l) D[a][l] -= L[a][k][l] * L[a][k][l] * D[k][l];
+            }
+            for (int b = a + 1; b < measure_dim; ++b) {
+                for (size_t l = 0; l < lanes; ++l) L[b][a][l] = B[b][a][l];
+                for (int k = 0; k < a; ++k) {
+                    for (size_t l = 0; l < lanes; ++l) L[b][a][l] -= L[b][k][l] * L[a][k][l] * D[k][l];
+                }
+                for (size_t l = 0; l < lanes; ++l) L[b][a][l] /= D[a][l];
+            }
+        }
+
+        // W = S^-1 [B | y]
+        float W[measure_dim][state_dim + 1][lanes];
+        for (int a = 0; a < measure_dim; ++a) {
+            copy_n(&B[a][0][0], state_dim * lanes, &W[a][0][0]);
+            copy_n(y[a], lanes, W[a][state_dim]);
+        }
+        for (int c = 0; c <= state_dim; ++c) {
+            for (int a = 0; a < measure_dim; ++a) {
+                for (int k = 0; k < a; ++k) {
+                    for (size_t l = 0; l < lanes; ++l) W[a][c][l] -= L[a][k][l] * W[k][c][l];
+                }
+            }
+            for (int a = 0; a < measure_dim; ++a) {
+                for (size_t l = 0; l < lanes; ++l) W[a][c][l] /= D[a][l];
+            }
+            for (int a = measure_dim - 1; a >= 0; --a) {
+                for (int k = a + 1; k < measure_dim; ++k) {
+                    for (size_t l = 0; l < lanes; ++l) W[a][c][l] -= L[k][a][l] * W[k][c][l];
+                }
+            }
+        }
+
+        // x += K y, P -= K H P, where K = (S^-1 H P)^T
+        for (int c = 0; c < state_dim; ++c) {
+            float dx[lanes] = {};
+            for (int a = 0; a < measure_dim; ++a) {
+                for (size_t l = 0; l < lanes; ++l) dx[l] += B[a][c][l] * W[a][state_dim][l];
+            }
+            for (size_t l = 0; l < len; ++l) {
+                x[c][t0 + l] += m[l] ? dx[l] : 0;
+            }
+        }
+        for (int c = 0; c < state_dim; ++c) {
+            for (int d = c; d < state_dim; ++d) {
+                float dp[lanes] = {};
+                for (int a = 0; a < measure_dim; ++a) {
+                    for (size_t l = 0; l < lanes; ++l) dp[l] += B[a][c][l] * W[a][d][l];
+                }
+                for (size_t l = 0; l < len; ++l) {
+                    P[sym(c, d)][t0 + l] -= m[l] ? dp[l] : 0;
+                }
+            }
+        }
+    }
+
+    update_rects(0, size());
+}
+
+array<float, KalmanFilterBank::innovation_size> KalmanFilterBank::innovation_cov(size_t t) const {
+    // H selects the first measure_dim state entries
+    auto r = measurement_noise(t);
+    array<float, innovation_size> S{};
+    auto k = 0;
+    for (int a = 0; a < measure_dim; ++a) {
+        for (int b = a; b < measure_dim; ++b) {
+            S[k++] = P[sym(a, b)][t] + (a == b ? r[a] : 0);
+        }
+    }
+    return S;
+}
+
+array<float, KalmanFilterBank::measure_dim> KalmanFilterBank::measurement_noise(size_t t) const {
+    if (noise != MotionNoise::BoxScaled) {
+        return {fixed_measurement_noise, fixed_measurement_noise, fixed_measurement_noise, fixed_measurement_noise};
+    }
+    auto v = scaled_noise(x[2][t], height(x[2][t], x[3][t]), std_weight_position, 0, std_aspect_measure);
+    return {v[0], v[1], v[2], v[3]};
+}
+
+void KalmanFilterBank::mahalanobis(const vector<int> &idx, const vector<cv::Rect2f> &boxes, float *dist) const {
+    const auto n = boxes.size();
+
+    array<vector<float>, measure_dim> zb;
+    for (auto &v:zb) v.resize(n);
+    for (size_t j = 0; j < n; ++j) {
+        auto xysr = get_xysr(boxes[j]);
+        for (int a = 0; a < measure_dim; ++a) {
+            zb[a][j] = xysr[a];
+        }
+    }
+
+    for (size_t i = 0; i < idx.size(); ++i) {
+        const auto t = idx[i];
+
+        // S = L D L^T once per filter, then d = y^T S^-1 y = |D^-1/2 L^-1 y|^2 for all boxes
+        auto S = innovation_cov(t);
+        float L[measure_dim][measure_dim] = {}, D[measure_dim], inv_D[measure_dim], hx[measure_dim];
+        for (int a = 0, k = 0; a < measure_dim; ++a) {
+            for (int b = a; b < measure_dim; ++b, ++k) {
+                L[b][a] = S[k];
+            }
+        }
+        for (int a = 0; a < measure_dim; ++a) {
+            D[a] = L[a][a];
+            for (int k = 0; k < a; ++k) D[a] -= L[a][k] * L[a][k] * D[k];
+            for (int b = a + 1; b < measure_dim; ++b) {
+                for (int k = 0; k < a; ++k) L[b][a] -= L[b][k] * L[a][k] * D[k];
+                L[b][a] /= D[a];
+            }
+            inv_D[a] = 1 / D[a];
+            hx[a] = x[a][t];
+        }
+
+        auto out = dist + i * n;
+        for (size_t j = 0; j < n; ++j) {
+            float w[measure_dim], d = 0;
+            for (int a = 0; a < measure_dim; ++a) {
+                w[a] = zb[a][j] - hx[a];
+                for (int k = 0; k < a; ++k) w[a] -= L[a][k] * w[k];
+                d += w[a] * w[a] * inv_D[a];
+            }
+            out[j] = d;
+        }
+    }
+}
+
+void KalmanFilterBank::update_rects(size_t begin, size_t end) {
+    // Convert bounding box from [cx,cy,s,r] to [x,y,w,h] style.
+    for (auto t = begin; t < end; ++t) {
+        auto cx = x[0][t], cy = x[1][t], s = x[2][t], r = x[3][t];
+        auto w = sqrt(s * r);
+        auto h = s / w;
+        _rects[t] = cv::Rect2f(cx - w / 2, cy - h / 2, w, h);
+    }
+}
@@ -0,0 +1,39 @@
+#include "KalmanTracker.h"
+
+// Age the track by one frame.
+void KalmanTracker::predict() {
+    ++time_since_update;
+}
+
+// Record a detection assigned to the track.
+void KalmanTracker::update(int &next_id) {
+    time_since_update = 0;
+    ++hits;
+
+    if (_state == TrackState::Tentative && hits > n_init) {
+        _state = TrackState::Confirmed;
+        _id = next_id++;
+    }
+}
+
+void KalmanTracker::miss() {
+    if (_state == TrackState::Tentative) {
+        _state = TrackState::Deleted;
+    } else if (time_since_update > max_age) {
+        _state = TrackState::Deleted;
+    }
+}
+
+void KalmanTracker::save(SnapshotWriter &out) const {
+    out.put(_state);
+    out.put(_id);
+    out.put(time_since_update);
+    out.put(hits);
+}
+
+void KalmanTracker::load(SnapshotReader &in) {
+    _state = in.get<TrackState>();
+    _id = in.get<int>();
+    time_since_update = in.get<int>();
+    hits = in.get<int>();
+}
@@ -0,0 +1,217 @@
+// Shortest augmenting path assignment after D.F. Crouse, "On implementing 2D rectangular assignment algorithms",
+// IEEE Transactions on Aerospace and Electronic Systems, 2016, which refines Jonker and Volgenant's LAPJV.
+//
+// Each row i owns an implicit dummy column that costs cost_limit and that no other row can take.
+// Dummy columns are always free, so they act as sinks of the search and never need dual variables.
+
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
+#include "LAPJV.h"
+
+using namespace std;
+
+namespace {
+    const float INF = numeric_limits<float>::infinity();
+
+    // sink marker of an augmenting path ending at the dummy column of a row
+    const int DUMMY = -2;
+}
+
+float LAPJV::solve(const CostView &cost, float cost_limit, vector<int> &row_to_col, float *row_duals) {
+    const auto nr = static_cast<int>(cost.rows), nc = static_cast<int>(cost.cols);
+
+    u.assign(nr, 0);
+    v.assign(nc, 0);
+    col4row.assign(nr, -1);
+    row4col.assign(nc, -1);
+    shortest.assign(nc, INF);
+    path.assign(nc, -1);
+    if (row_duals) {
+        for (int i = 0; i < nr; ++i) {
+            u[i] = min(row_duals[i], cost_limit);
+        }
+        warm_start(cost, cost_limit);
+    }
+
+    for (int cur_row = 0; cur_row < nr; ++cur_row) {
+        if (col4row[cur_row] != -1) continue;
+
+        auto min_val = 0.0f;
+        auto sink = augmenting_path(cost, cost_limit, cur_row, min_val);
+
+        // update dual variables
+        u[cur_row] += min_val;
+        for (auto i:scanned_rows) {
+            if (i != cur_row) {
+                u[i] += min_val - shortest[col4row[i]];
+            }
+        }
+        for (auto j:scanned_cols) {
+            v[j] -= min_val - shortest[j];
+        }
+
+        // augment previous solution
+        int j;
+        if (sink == DUMMY) {
+            // the last scanned row leaves its column for the dummy one
+            auto i = scanned_rows.back();
+            j = col4row[i];
+            col4row[i] = -1;
+            if (i == cur_row) continue;
+        } else {
+            j = sink;
+        }
+        while (true) {
+            auto i = path[j];
+            row4col[j] = i;
+            swap(col4row[i], j);
+            if (i == cur_row) break;
+        }
+    }
+
+    auto total = 0.0f;
+    for (int i = 0; i < nr; ++i) {
+        if (col4row[i] != -1) {
+            total += cost(i, col4row[i]);
+        }
+    }
+    row_to_col = col4row;
+    if (row_duals) {
+        copy(u.begin(), u.end(), row_duals);
+    }
+    return total;
+}
+
+// The search needs c(i,j) - u[i] - v[j] >= 0 on every valid pair, cost_limit - u[i] >= 0 for the dummy columns,
+// v[j] <= 0, and pairs in the partial assignment at zero, with v[j] < 0 only on assigned columns.
+// Each column gets v[j] = min(0, min_i c(i,j) - u[i]) and, if negative, the row attaining it.
+// When that row is taken by another column, rows are lowered until the column can stay free at 0,
+// and the columns of lowered rows are looked at again. A column freed that way never goes below 0 again.
+// Rows still free can then rise as long as every pair stays feasible.
+void LAPJV::warm_start(const CostView &cost, float cost_limit) {
+    const auto nr = static_cast<int>(cost.rows), nc = static_cast<int>(cost.cols);
+
+    remaining.resize(nc);
+    iota(remaining.begin(), remaining.end(), 0);
+    while (!remaining.empty()) {
+        auto j = remaining.back();
+        remaining.pop_back();
+
+        auto best = 0.0f;
+        auto best_row = -1;
+        for (int i = 0; i < nr; ++i) {
+            auto c = cost(i, j);
+            if (c <= cost_limit && c - u[i] < best) {
+                best = c - u[i];
+                best_row = i;
+            }
+        }
+        v[j] = best;
+        if (best_row == -1) continue;
+
+        if (col4row[best_row] == -1) {
+            col4row[best_row] = j;
+            row4col[j] = best_row;
+            continue;
+        }
+        v[j] = 0;
+        for (int i = 0; i < nr; ++i) {
+            auto c = cost(i, j);
+            if (c <= cost_limit && c < u[i]) {
+                u[i] = c;
+                if (col4row[i] != -1) {
+                    // no longer tight
+                    remaining.push_back(col4row[i]);
+                    row4col[col4row[i]] = -1;
+                    col4row[i] = -1;
+                }
+            }
+        }
+    }
+
+    // rows left free rise to their cheapest pair, taking it if it is free
+    for (int i = 0; i < nr; ++i) {
+        if (col4row[i] != -1) continue;
+        auto best = cost_limit;
+        auto best_col = -1;
+        for (int j = 0; j < nc; ++j) {
+            auto c = cost(i, j);
+            if (c <= cost_limit && c - v[j] < best) {
+                best = c - v[j];
+                best_col = j;
+            }
+        }
+        u[i] = best;
+        if (best_col != -1 && row4col[best_col] == -1) {
+            col4row[i] = best_col;
+            row4col[best_col] = i;
+        }
+    }
+}
+
+// Dijkstra search from cur_row over reduced costs. Return the sink column or DUMMY,
+// leaving the row whose dummy column is the sink at the back of scanned_rows.
+int LAPJV::augmenting_path(const CostView &cost, float cost_limit, int cur_row, float &min_val) {
+    const auto nc = static_cast<int>(cost.cols);
+
+    scanned_rows.clear();
+    scanned_cols.clear();
+    remaining.resize(nc);
+    for (int it = 0; it < nc; ++it) {
+        remaining[it] = nc - it - 1;
+        shortest[it] = INF;
+    }
+    auto num_remaining = nc;
+
+    // cheapest dummy column seen so far and the row owning it
+    auto dummy_cost = INF;
+    auto dummy_row = -1;
+
+    auto i = cur_row;
+    while (true) {
+        scanned_rows.push_back(i);
+
+        if (min_val + cost_limit - u[i] < dummy_cost) {
+            dummy_cost = min_val + cost_limit - u[i];
+            dummy_row = i;
+        }
+
+        auto lowest = INF;
+        auto index = -1;
+        for (int it = 0; it < num_remaining; ++it) {
+            auto j = remaining[it];
+            auto c = cost(i, j);
+            if (c <= cost_limit) {
+                auto r = min_val + c - u[i] - v[j];
+                if (r < shortest[j]) {
+                    path[j] = i;
+                    shortest[j] = r;
+                }
+            }
+            if (shortest[j] < lowest || (shortest[j] == lowest && row4col[j] == -1)) {
+                lowest = shortest[j];
+                index = it;
+            }
+        }
+
+        // dummy columns are free, take one unless a real free column is as cheap
+        if (index == -1 || dummy_cost < lowest ||
+            (dummy_cost == lowest && row4col[remaining[index]] != -1)) {
+            min_val = dummy_cost;
+            // move the owner to the back, its scanned order does not matter for the duals
+            swap(*find(scanned_rows.begin(), scanned_rows.end(), dummy_row), scanned_rows.back());
+            return DUMMY;
+        }
+
+        min_val = lowest;
+        auto j = remaining[index];
+        scanned_cols.push_back(j);
+        remaining[index] = remaining[--num_remaining];
+        if (row4col[j] == -1) {
+            return j;
+        }
+        i = row4col[j];
+    }
+}
@@ -0,0 +1,71 @@
+#include <chrono>
+
+#include "SORT.h"
+#include "TrackerManager.h"
+#include "KalmanTracker.h"
+#include "nn_matching.h"
+
+using namespace std;
+
+namespace {
+    const uint32_t snapshot_tag = 0x54524f53;  // "SORT"
+    const uint32_t snapshot_version = 1;
+}
+
+struct SORT::TrackData {
+    KalmanTracker kalman;
+};
+
+SORT::SORT(const array<int64_t, 2> &dim, TaskPool *pool, const AssociationOptions &association)
+        : manager(make_unique<TrackerManager<TrackData>>(dim, nullptr, pool, association)) {}
+
+SORT::~SORT() = default;
+
+vector<Track> SORT::update(const vector<cv::Rect2f> &detections) {
+    manager->predict();
+    manager->remove_nan();
+
+    auto metric = [this, &detections](const std::vector<int> &trk_ids, const std::vector<int> &det_ids) {
+        vector<cv::Rect2f> trks;
+        for (auto t : trk_ids) {
+            trks.push_back(manager->rects()[t]);
+        }
+        vector<cv::Rect2f> dets;
+        for (auto &d:det_ids) {
+            dets.push_back(detections[d]);
+        }
+        return iou_dist(dets, trks, 0.7f);
+    };
+    auto start = chrono::steady_clock::now();
+    manager->update(detections, metric, metric);
+    _stats.association_time += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    ++_stats.frames;
+    _stats.assignment = manager->assignment_stats();
+
+    manager->remove_deleted();
+
+    return manager->visible_tracks();
+}
+
+size_t SORT::bytes() const {
+    return manager->bytes();
+}
+
+vector<uint8_t> SORT::snapshot() const {
+    SnapshotWriter out;
+    out.put(snapshot_tag);
+    out.put(snapshot_version);
+    manager->save(out, [](const TrackData &, SnapshotWriter &) {});
+    return move(out.data());
+}
+
+void SORT::restore(const vector<uint8_t> &snapshot) {
+    SnapshotReader in(snapshot);
+    in.expect(snapshot_tag, snapshot_version);
+    TrackerManager<TrackData> loaded(manager->dim());
+    loaded.load(in, [](TrackData &, SnapshotReader &) {});
+    if (!in.at_end()) {
+        throw runtime_error("Snapshot has trailing data");
+    }
+    manager->swap_tracks(loaded);
+}
@@ -0,0 +1,335 @@
+#include <limits>
+#include <numeric>
+#include <algorithm>
+
+#include "SparseAssignment.h"
+
+using namespace std;
+
+namespace {
+    const float INF = numeric_limits<float>::infinity();
+
+    // rough number of operations above which components are solved in parallel
+    const int64_t parallel_work = 1 << 18;
+
+    // auction bids between two looks at the clock
+    const int64_t bids_per_clock = 64;
+
+    // excess cost below which an approximate assignment counts as optimal, for float rounding
+    const double cost_tolerance = 1e-4;
+}
+
+int SparseAssignment::find(int x) {
+    while (parent[x] != x) {
+        parent[x] = parent[parent[x]];
+        x = parent[x];
+    }
+    return x;
+}
+
+void SparseAssignment::solve(const CostView &cost, float cost_limit, vector<int> &row_to_col, float *row_duals) {
+    edges.clear();
+    for (int i = 0; i < cost.rows; ++i) {
+        for (int j = 0; j < cost.cols; ++j) {
+            auto c = cost(i, j);
+            if (c <= cost_limit) edges.push_back({i, j, c});
+        }
+    }
+    solve_edges(static_cast<int>(cost.rows), static_cast<int>(cost.cols), cost_limit, row_to_col, row_duals);
+}
+
+void SparseAssignment::solve(const CostMatrix &cost, float cost_limit, vector<int> &row_to_col, float *row_duals) {
+    if (!cost.is_sparse()) {
+        solve(cost.view(), cost_limit, row_to_col, row_duals);
+        return;
+    }
+    edges.clear();
+    for (auto &e:cost.entries()) {
+        if (e.cost <= cost_limit) edges.push_back(e);
+    }
+    solve_edges(static_cast<int>(cost.rows()), static_cast<int>(cost.cols()), cost_limit, row_to_col, row_duals);
+}
+
+void SparseAssignment::solve_edges(int nr, int nc, float cost_limit, vector<int> &row_to_col, float *row_duals) {
+    const auto n_nodes = nr + nc;
+    n_rows = nr;
+    row_to_col.assign(nr, -1);
+    const auto deadline = Clock::now() + chrono::duration_cast<Clock::duration>(
+            chrono::duration<double, milli>(options.time_budget_ms));
+    // every solve counts towards the check interval, including those without a valid pair
+    checking = options.mode != AssociationMode::Optimal && options.check_interval > 0 &&
+               ++n_solves % options.check_interval == 0;
+
+    // components connected by the valid pairs
+    parent.resize(n_nodes);
+    iota(parent.begin(), parent.end(), 0);
+    for (auto &e:edges) {
+        auto a = find(e.row), b = find(nr + e.col);
+        if (a != b) parent[a] = b;
+    }
+
+    // number the components, nodes without any valid pair stay unassigned
+    vector<uint8_t> has_edge(n_nodes);
+    for (auto &e:edges) {
+        has_edge[e.row] = has_edge[nr + e.col] = 1;
+    }
+    if (row_duals) {
+        // rows left alone sit on their dummy column
+        for (int i = 0; i < nr; ++i) {
+            if (!has_edge[i]) row_duals[i] = cost_limit;
+        }
+    }
+    if (edges.empty()) {
+        // nothing to assign is trivially optimal
+        if (checking) ++_stats.checked;
+        return;
+    }
+    vector<int> comp_of_root(n_nodes, -1);
+    comp_of_node.assign(n_nodes, -1);
+    auto n_comp = 0;
+    for (int x = 0; x < n_nodes; ++x) {
+        if (has_edge[x]) {
+            auto &c = comp_of_root[find(x)];
+            if (c == -1) c = n_comp++;
+            comp_of_node[x] = c;
+        }
+    }
+
+    // group nodes by component, rows ahead of columns, and give them local indices
+    node_offset.assign(n_comp + 1, 0);
+    comp_rows.assign(n_comp, 0);
+    for (int x = 0; x < n_nodes; ++x) {
+        if (comp_of_node[x] != -1) {
+            ++node_offset[comp_of_node[x] + 1];
+            if (x < nr) ++comp_rows[comp_of_node[x]];
+        }
+    }
+    partial_sum(node_offset.begin(), node_offset.end(), node_offset.begin());
+    nodes.resize(node_offset.back());
+    local.assign(n_nodes, -1);
+    vector<int> pos(node_offset.begin(), node_offset.end() - 1);
+    for (int x = 0; x < n_nodes; ++x) {
+        auto c = comp_of_node[x];
+        if (c != -1) {
+            local[x] = pos[c] - node_offset[c] - (x < nr ? 0 : comp_rows[c]);
+            nodes[pos[c]++] = x;
+        }
+    }
+
+    // group edges by component
+    edge_offset.assign(n_comp + 1, 0);
+    for (auto &e:edges) {
+        ++edge_offset[comp_of_node[e.row] + 1];
+    }
+    partial_sum(edge_offset.begin(), edge_offset.end(), edge_offset.begin());
+    comp_edges.resize(edges.size());
+    pos.assign(edge_offset.begin(), edge_offset.end() - 1);
+    for (size_t k = 0; k < edges.size(); ++k) {
+        comp_edges[pos[comp_of_node[edges[k].row]]++] = k;
+    }
+
+    // largest components first to balance the lanes
+    vector<int> order(n_comp);
+    vector<int64_t> work(n_comp);
+    int64_t total_work = 0;
+    for (int c = 0; c < n_comp; ++c) {
+        int64_t r = comp_rows[c], k = node_offset[c + 1] - node_offset[c] - r;
+        work[c] = r > 1 && k > 1 ? r * r * k : 0;
+        total_work += work[c];
+    }
+    iota(order.begin(), order.end(), 0);
+    sort(order.begin(), order.end(), [&work](int a, int b) { return work[a] > work[b]; });
+
+    auto n_lanes = pool && total_work > parallel_work ? pool->lanes() : 1;
+    if (workers.size() < n_lanes) {
+        workers.resize(n_lanes);
+    }
+
+    if (n_lanes == 1) {
+        for (auto c:order) {
+            solve_component(workers[0], c, cost_limit, row_to_col, row_duals, deadline);
+        }
+    } else {
+        pool->parallel_for(order.size(), [&](size_t it, size_t lane) {
+            solve_component(workers[lane], order[it], cost_limit, row_to_col, row_duals, deadline);
+        });
+    }
+
+    double excess = 0;
+    for (auto &w:workers) {
+        excess += w.excess;
+        _stats.over_budget += w.over_budget;
+        w.excess = 0;
+        w.over_budget = 0;
+    }
+    if (checking) {
+        ++_stats.checked;
+        if (excess > cost_tolerance) {
+            ++_stats.deviating;
+            _stats.excess_cost += excess;
+        }
+    }
+}
+
+void SparseAssignment::solve_component(Worker &w, int c, float cost_limit, vector<int> &row_to_col,
+                                       float *row_duals, Clock::time_point deadline) {
+    auto r = comp_rows[c];
+    auto k = node_offset[c + 1] - node_offset[c] - r;
+    auto e_begin = comp_edges.begin() + edge_offset[c], e_end = comp_edges.begin() + edge_offset[c + 1];
+    auto rows = nodes.begin() + node_offset[c];
+    auto cols = rows + r;
+
+    // with a single row or column only one pair can be matched, take the cheapest
+    if (r == 1 || k == 1) {
+        auto best = *min_element(e_begin, e_end,
+                                 [this](int a, int b) { return edges[a].cost < edges[b].cost; });
+        row_to_col[edges[best].row] = edges[best].col;
+        if (row_duals) {
+            // optimal duals: a single row is tight on its pair, rows losing a single column sit on their dummy,
+            // and the column is priced by the runner-up
+            auto runner_up = cost_limit;
+            for (auto it = e_begin; it != e_end; ++it) {
+                if (*it != best) runner_up = min(runner_up, edges[*it].cost);
+            }
+            for (auto it = rows; it != cols; ++it) {
+                row_duals[*it] = cost_limit;
+            }
+            row_duals[edges[best].row] = r == 1 ? edges[best].cost : edges[best].cost - runner_up + cost_limit;
+        }
+        return;
+    }
+
+    const auto optimal = options.mode == AssociationMode::Optimal;
+    if (optimal || checking) {
+        w.sub_cost.assign(size_t(r) * k, INF);
+        for (auto it = e_begin; it != e_end; ++it) {
+            auto &e = edges[*it];
+            w.sub_cost[local[e.row] * k + local[n_rows + e.col]] = e.cost;
+        }
+    }
+
+    if (!optimal) {
+        w.sub_assignment.assign(r, -1);
+        w.owner.assign(k, -1);
+        if (options.mode == AssociationMode::Auction && !auction(w, c, cost_limit, deadline)) {
+            ++w.over_budget;
+        }
+        // whatever the auction left, any valid pair is cheaper than two unmatched nodes
+        greedy(w, c);
+
+        if (checking) {
+            auto total = [&w, r, k, cost_limit](const vector<int> &assignment) {
+                double sum = 0;
+                for (int i = 0; i < r; ++i) {
+                    sum += assignment[i] == -1 ? cost_limit : w.sub_cost[size_t(i) * k + assignment[i]];
+                }
+                return sum;
+            };
+            w.solver.solve(CostView(w.sub_cost.data(), r, k), cost_limit, w.exact);
+            w.excess += max(total(w.sub_assignment) - total(w.exact), 0.0);
+        }
+
+        for (int i = 0; i < r; ++i) {
+            if (w.sub_assignment[i] != -1) {
+                row_to_col[rows[i]] = cols[w.sub_assignment[i]] - n_rows;
+            }
+        }
+        return;
+    }
+
+    float *sub_duals = nullptr;
+    if (row_duals) {
+        w.sub_duals.resize(r);
+        for (int i = 0; i < r; ++i) {
+            w.sub_duals[i] = row_duals[rows[i]];
+        }
+        sub_duals = w.sub_duals.data();
+    }
+    w.solver.solve(CostView(w.sub_cost.data(), r, k), cost_limit, w.sub_assignment, sub_duals);
+
+    for (int i = 0; i < r; ++i) {
+        if (w.sub_assignment[i] != -1) {
+            row_to_col[rows[i]] = cols[w.sub_assignment[i]] - n_rows;
+        }
+        if (row_duals) row_duals[rows[i]] = sub_duals[i];
+    }
+}
+
+void SparseAssignment::greedy(Worker &w, int c) {
+    w.sorted.clear();
+    for (auto it = edge_offset[c]; it < edge_offset[c + 1]; ++it) {
+        auto &e = edges[comp_edges[it]];
+        if (w.sub_assignment[local[e.row]] == -1 && w.owner[local[n_rows + e.col]] == -1) {
+            w.sorted.push_back(comp_edges[it]);
+        }
+    }
+    sort(w.sorted.begin(), w.sorted.end(), [this](int a, int b) { return edges[a].cost < edges[b].cost; });
+
+    for (auto it:w.sorted) {
+        auto i = local[edges[it].row], j = local[n_rows + edges[it].col];
+        if (w.sub_assignment[i] == -1 && w.owner[j] == -1) {
+            w.sub_assignment[i] = j;
+            w.owner[j] = i;
+        }
+    }
+}
+
+bool SparseAssignment::auction(Worker &w, int c, float cost_limit, Clock::time_point deadline) {
+    const auto r = comp_rows[c], k = node_offset[c + 1] - node_offset[c] - r;
+    // a row gains cost_limit - cost from a pair, and nothing from its dummy column, whose price stays 0.
+    // Prices start at 0 and a column keeps an owner once bid for, so unowned columns stay at price 0 and the result
+    // is within epsilon per row of optimal. Scaling epsilon down over phases would lose this bound, as a later phase
+    // starts from prices raised on columns it may leave unowned, so a single phase runs with the final epsilon
+
+    // pairs of each row, in local column indices
+    w.adj_offset.assign(r + 1, 0);
+    for (auto it = edge_offset[c]; it < edge_offset[c + 1]; ++it) {
+        ++w.adj_offset[local[edges[comp_edges[it]].row] + 1];
+    }
+    partial_sum(w.adj_offset.begin(), w.adj_offset.end(), w.adj_offset.begin());
+    w.adj.resize(w.adj_offset.back());
+    w.queue.assign(w.adj_offset.begin(), w.adj_offset.end() - 1);
+    for (auto it = edge_offset[c]; it < edge_offset[c + 1]; ++it) {
+        auto &e = edges[comp_edges[it]];
+        w.adj[w.queue[local[e.row]]++] = {local[n_rows + e.col], e.cost};
+    }
+
+    w.price.assign(k, 0);
+    w.queue.resize(r);
+    iota(w.queue.begin(), w.queue.end(), 0);
+
+    int64_t bids = 0;
+    while (!w.queue.empty()) {
+        if (++bids % bids_per_clock == 0 && Clock::now() > deadline) return false;
+
+        auto i = w.queue.back();
+        w.queue.pop_back();
+
+        // best and second best value, the dummy column counting as 0
+        auto best = 0.0f, second = 0.0f;
+        auto j_best = -1;
+        for (auto it = w.adj_offset[i]; it < w.adj_offset[i + 1]; ++it) {
+            auto j = w.adj[it].first;
+            auto v = cost_limit - w.adj[it].second - w.price[j];
+            if (v > best) {
+                second = best;
+                best = v;
+                j_best = j;
+            } else if (v > second) {
+                second = v;
+            }
+        }
+        // a row left with its dummy column keeps it, as prices only rise
+        if (j_best == -1) continue;
+
+        w.price[j_best] += best - second + options.epsilon;
+        auto &owner = w.owner[j_best];
+        if (owner != -1) {
+            w.sub_assignment[owner] = -1;
+            w.queue.push_back(owner);
+        }
+        owner = i;
+        w.sub_assignment[i] = j_best;
+    }
+    return true;
+}
@@ -0,0 +1,95 @@
+#include <cmath>
+#include <cfloat>
+#include <numeric>
+#include <algorithm>
+
+#include "SpatialGrid.h"
+
+using namespace std;
+
+namespace {
+    // cap on the grid size, so that a few huge boxes cannot blow up the number of cells
+    const float max_cells_per_side = 128;
+
+    bool overlap(const cv::Rect2f &a, const cv::Rect2f &b) {
+        return min(a.x + a.width, b.x + b.width) > max(a.x, b.x) &&
+               min(a.y + a.height, b.y + b.height) > max(a.y, b.y);
+    }
+}
+
+int SpatialGrid::cell_of(float v, float origin, int n) const {
+    return static_cast<int>(min(max(floor((v - origin) / cell), -1.0f), float(n)));
+}
+
+void SpatialGrid::build(const vector<cv::Rect2f> &boxes) {
+    this->boxes = boxes;
+    entries.clear();
+    cell_offset.assign(1, 0);
+    seen.assign(boxes.size(), -1);
+    n_cols = n_rows = n_queries = 0;
+    if (boxes.empty()) return;
+
+    auto x1 = FLT_MAX, y1 = FLT_MAX, x2 = -FLT_MAX, y2 = -FLT_MAX;
+    auto extent = 0.0f;
+    for (auto &g:boxes) {
+        x1 = min(x1, g.x);
+        y1 = min(y1, g.y);
+        x2 = max(x2, g.x + g.width);
+        y2 = max(y2, g.y + g.height);
+        extent += max(g.width, g.height);
+    }
+
+    // cells about the size of an average box, so that each box covers a few of them
+    cell = max({extent / boxes.size(), (x2 - x1) / max_cells_per_side, (y2 - y1) / max_cells_per_side, 1.0f});
+    x0 = x1;
+    y0 = y1;
+    n_cols = static_cast<int>((x2 - x1) / cell) + 1;
+    n_rows = static_cast<int>((y2 - y1) / cell) + 1;
+
+    // counting sort of the boxes by cell
+    auto for_cells = [this](const cv::Rect2f &g, auto f) {
+        auto cx1 = max(cell_of(g.x, x0, n_cols), 0), cx2 = min(cell_of(g.x + g.width, x0, n_cols), n_cols - 1);
+        auto cy1 = max(cell_of(g.y, y0, n_rows), 0), cy2 = min(cell_of(g.y + g.height, y0, n_rows), n_rows - 1);
+        for (auto cy = cy1; cy <= cy2; ++cy) {
+            for (auto cx = cx1; cx <= cx2; ++cx) {
+                f(cy * n_cols + cx);
+            }
+        }
+    };
+    cell_offset.assign(size_t(n_cols) * n_rows + 1, 0);
+    for (auto &g:boxes) {
+        for_cells(g, [this](int c) { ++cell_offset[c + 1]; });
+    }
+    partial_sum(cell_offset.begin(), cell_offset.end(), cell_offset.begin());
+    entries.resize(cell_offset.back());
+    vector<int> pos(cell_offset.begin(), cell_offset.end() - 1);
+    for (size_t k = 0; k < boxes.size(); ++k) {
+        for_cells(boxes[k], [this, &pos, k](int c) { entries[pos[c]++] = k; });
+    }
+}
+
+void SpatialGrid::query(const cv::Rect2f &query, vector<int> &out) {
+    if (boxes.empty()) return;
+
+    auto cx1 = cell_of(query.x, x0, n_cols), cx2 = cell_of(query.x + query.width, x0, n_cols);
+    auto cy1 = cell_of(query.y, y0, n_rows), cy2 = cell_of(query.y + query.height, y0, n_rows);
+    if (cx2 < 0 || cx1 >= n_cols || cy2 < 0 || cy1 >= n_rows) return;
+    cx1 = max(cx1, 0);
+    cy1 = max(cy1, 0);
+    cx2 = min(cx2, n_cols - 1);
+    cy2 = min(cy2, n_rows - 1);
+
+    ++n_queries;
+    for (auto cy = cy1; cy <= cy2; ++cy) {
+        for (auto cx = cx1; cx <= cx2; ++cx) {
+            auto c = cy * n_cols + cx;
+            for (auto it = cell_offset[c]; it < cell_offset[c + 1]; ++it) {
+                auto k = entries[it];
+                if (seen[k] != n_queries) {
+                    seen[k] = n_queries;
+                    if (overlap(boxes[k], query)) out.push_back(k);
+                }
+            }
+        }
+    }
+}
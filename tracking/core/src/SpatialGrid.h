@@ -0,0 +1,32 @@
+#ifndef SPATIAL_GRID_H
+#define SPATIAL_GRID_H
+
+#include <vector>
+#include <opencv2/opencv.hpp>
+
+// Uniform grid over a set of boxes, rebuilt every frame, listing the boxes overlapping a query box.
+// Each box is bucketed into the cells it covers.
+class SpatialGrid {
+public:
+    void build(const std::vector<cv::Rect2f> &boxes);
+
+    // append the indices of boxes overlapping query, each at most once
+    void query(const cv::Rect2f &query, std::vector<int> &out);
+
+private:
+    // cell coordinate of v, clamped to [-1, n]
+    int cell_of(float v, float origin, int n) const;
+
+    float cell = 1, x0 = 0, y0 = 0;
+    int n_cols = 0, n_rows = 0;
+    std::vector<cv::Rect2f> boxes;
+
+    // box indices bucketed by cell, indexed by the offsets
+    std::vector<int> cell_offset, entries;
+
+    // last query that reported each box, to skip duplicates from neighbouring cells
+    std::vector<int> seen;
+    int n_queries = 0;
+};
+
+#endif //SPATIAL_GRID_H
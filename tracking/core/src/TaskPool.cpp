@@ -0,0 +1,129 @@
+#include <algorithm>
+
+#include "TaskPool.h"
+
+using namespace std;
+
+namespace {
+    // pool and queue of the worker running on this thread
+    thread_local const TaskPool *current_pool = nullptr;
+    thread_local size_t current_queue = 0;
+}
+
+TaskPool::TaskPool(size_t n_threads) {
+    n_threads = max<size_t>(n_threads, 1);
+    for (size_t i = 0; i < n_threads; ++i) {
+        queues.push_back(make_unique<Queue>());
+    }
+    for (size_t i = 0; i < n_threads; ++i) {
+        threads.emplace_back(&TaskPool::work, this, i);
+    }
+}
+
+TaskPool::~TaskPool() {
+    {
+        lock_guard<std::mutex> lock(mutex);
+        stop = true;
+    }
+    wake.notify_all();
+    for (auto &t:threads) {
+        t.join();
+    }
+}
+
+void TaskPool::submit(function<void()> task) {
+    // workers keep their tasks local, other threads spread theirs
+    auto q = current_pool == this ? current_queue : next_queue++ % queues.size();
+    // counted before the task is visible, so that a worker taking it at once cannot make pending wrap
+    ++unfinished;
+    {
+        lock_guard<std::mutex> lock(mutex);
+        ++pending;
+    }
+    {
+        lock_guard<std::mutex> lock(queues[q]->mutex);
+        queues[q]->tasks.push_back(move(task));
+    }
+    wake.notify_one();
+}
+
+bool TaskPool::try_run(size_t self) {
+    function<void()> task;
+    for (size_t k = 0; k < queues.size() && !task; ++k) {
+        auto &q = *queues[(self + k) % queues.size()];
+        lock_guard<std::mutex> lock(q.mutex);
+        if (q.tasks.empty()) continue;
+        // own queue from the back, others from the front
+        if (k == 0) {
+            task = move(q.tasks.back());
+            q.tasks.pop_back();
+        } else {
+            task = move(q.tasks.front());
+            q.tasks.pop_front();
+        }
+    }
+    if (!task) return false;
+
+    {
+        lock_guard<std::mutex> lock(mutex);
+        --pending;
+    }
+    task();
+    if (--unfinished == 0) {
+        lock_guard<std::mutex> lock(mutex);
+        idle.notify_all();
+    }
+    return true;
+}
+
+void TaskPool::work(size_t self) {
+    current_pool = this;
+    current_queue = self;
+    while (true) {
+        if (try_run(self)) continue;
+
+        unique_lock<std::mutex> lock(mutex);
+        wake.wait(lock, [this] { return stop || pending > 0; });
+        if (stop && pending == 0) return;
+    }
+}
+
+void TaskPool::parallel_for(size_t n, const function<void(size_t, size_t)> &f) {
+    if (n == 0) return;
+
+    // indices are claimed one by one, helpers starting late find none left and return at once
+    struct State {
+        atomic<size_t> next{0};
+        // the caller sleeps on finished until done reaches n
+        size_t done = 0;
+        std::mutex mutex;
+        condition_variable finished;
+    };
+    auto state = make_shared<State>();
+    auto run = [state, n, &f](size_t lane) {
+        size_t ran = 0;
+        for (size_t i; (i = state->next++) < n; ++ran) {
+            f(i, lane);
+        }
+        if (ran == 0) return;
+        lock_guard<std::mutex> lock(state->mutex);
+        state->done += ran;
+        if (state->done == n) state->finished.notify_one();
+    };
+
+    auto n_runners = min(n, lanes());
+    for (size_t lane = 1; lane < n_runners; ++lane) {
+        submit([run, lane] { run(lane); });
+    }
+    run(0);
+
+    // remaining indices are running on started helpers, so waiting on them cannot deadlock.
+    // Other tasks are not run meanwhile, they may need locks held by the caller.
+    unique_lock<std::mutex> lock(state->mutex);
+    state->finished.wait(lock, [&state, n] { return state->done == n; });
+}
+
+void TaskPool::wait() {
+    unique_lock<std::mutex> lock(mutex);
+    idle.wait(lock, [this] { return unfinished == 0; });
+}
@@ -0,0 +1,48 @@
+#include <algorithm>
+
+#include "TrackerManager.h"
+
+using namespace std;
+using namespace cv;
+
+void associate_detections_to_trackers_idx(const DistanceMetricFunc &metric,
+                                          SparseAssignment &solver,
+                                          vector<int> &unmatched_trks,
+                                          vector<int> &unmatched_dets,
+                                          vector<tuple<int, int>> &matched,
+                                          vector<float> &duals) {
+    auto dist = metric(unmatched_trks, unmatched_dets);
+
+    // the solver starts from the duals the tracks had in the last frame
+    vector<float> trk_duals;
+    for (auto t:unmatched_trks) {
+        trk_duals.push_back(duals[t]);
+    }
+
+    // pairs costing more than the limit are left unmatched by the solver
+    vector<int> assignment;
+    solver.solve(dist, INVALID_DIST / 10, assignment, trk_duals.data());
+    for (size_t i = 0; i < unmatched_trks.size(); ++i) {
+        duals[unmatched_trks[i]] = trk_duals[i];
+    }
+
+    vector<uint8_t> det_matched(unmatched_dets.size());
+    for (size_t i = 0; i < assignment.size(); ++i) {
+        if (assignment[i] != -1) {
+            matched.emplace_back(make_tuple(unmatched_trks[i], unmatched_dets[assignment[i]]));
+            det_matched[assignment[i]] = 1;
+            unmatched_trks[i] = -1;
+        }
+    }
+
+    unmatched_trks.erase(remove(unmatched_trks.begin(), unmatched_trks.end(), -1),
+                         unmatched_trks.end());
+
+    size_t k = 0;
+    for (size_t j = 0; j < unmatched_dets.size(); ++j) {
+        if (!det_matched[j]) {
+            unmatched_dets[k++] = unmatched_dets[j];
+        }
+    }
+    unmatched_dets.resize(k);
+}
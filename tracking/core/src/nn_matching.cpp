@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cfloat>
+
+#include "nn_matching.h"
+#include "SpatialGrid.h"
+
+using namespace std;
+using namespace cv;
+
+namespace {
+    // number of pairs above which candidates are listed by the spatial grid
+    const size_t sparse_pairs = 1 << 12;
+
+    float pair_iou_dist(float t_x1, float t_y1, float t_x2, float t_y2, float t_area,
+                        float d_x1, float d_y1, float d_x2, float d_y2, float d_area, float max_dist) {
+        auto w = min(t_x2, d_x2) - max(t_x1, d_x1);
+        auto h = min(t_y2, d_y2) - max(t_y1, d_y1);
+        auto in = (w > 0 ? w : 0.0f) * (h > 0 ? h : 0.0f);
+        auto un = t_area + d_area - in;
+        auto d = 1.0f - in / (un < FLT_EPSILON ? 1.0f : un);
+        return d > max_dist ? INVALID_DIST : d;
+    }
+}
+
+BoxArray::BoxArray(const vector<Rect2f> &rects) {
+    for (auto &r:rects) {
+        push_back(r);
+    }
+}
+
+void BoxArray::push_back(const Rect2f &rect) {
+    x1.push_back(rect.x);
+    y1.push_back(rect.y);
+    x2.push_back(rect.x + rect.width);
+    y2.push_back(rect.y + rect.height);
+    area.push_back(rect.area());
+}
+
+void iou_dist(const BoxArray &trks, const BoxArray &dets, float max_dist, float *dist) {
+    const auto det_num = dets.size();
+    const auto d_x1 = dets.x1.data(), d_y1 = dets.y1.data(), d_x2 = dets.x2.data(), d_y2 = dets.y2.data();
+    const auto d_area = dets.area.data();
+
+    // branch-free inner loop over detections, so that it vectorizes
+    for (size_t i = 0; i < trks.size(); ++i) {
+        const auto t_x1 = trks.x1[i], t_y1 = trks.y1[i], t_x2 = trks.x2[i], t_y2 = trks.y2[i];
+        const auto t_area = trks.area[i];
+        auto row = dist + i * det_num;
+        for (size_t j = 0; j < det_num; ++j) {
+            row[j] = pair_iou_dist(t_x1, t_y1, t_x2, t_y2, t_area,
+                                   d_x1[j], d_y1[j], d_x2[j], d_y2[j], d_area[j], max_dist);
+        }
+    }
+}
+
+void iou_dist(const BoxArray &trks, const BoxArray &dets,
+              const vector<int> &trk_idx, const vector<int> &det_idx, float max_dist, float *dist) {
+    for (size_t k = 0; k < trk_idx.size(); ++k) {
+        auto i = trk_idx[k], j = det_idx[k];
+        dist[k] = pair_iou_dist(trks.x1[i], trks.y1[i], trks.x2[i], trks.y2[i], trks.area[i],
+                                dets.x1[j], dets.y1[j], dets.x2[j], dets.y2[j], dets.area[j], max_dist);
+    }
+}
+
+CostMatrix iou_dist(const vector<Rect2f> &dets, const vector<Rect2f> &trks, float max_dist) {
+    if (max_dist >= 1 || trks.size() * dets.size() < sparse_pairs) {
+        CostMatrix dist(trks.size(), dets.size());
+        iou_dist(BoxArray(trks), BoxArray(dets), max_dist, dist.data());
+        return dist;
+    }
+
+    SpatialGrid grid;
+    grid.build(trks);
+    vector<int> trk_idx, det_idx, near;
+    for (size_t j = 0; j < dets.size(); ++j) {
+        near.clear();
+        grid.query(dets[j], near);
+        for (auto i:near) {
+            trk_idx.push_back(i);
+            det_idx.push_back(j);
+        }
+    }
+    vector<float> pair_dist(trk_idx.size());
+    iou_dist(BoxArray(trks), BoxArray(dets), trk_idx, det_idx, max_dist, pair_dist.data());
+
+    // only the valid pairs go on to the assignment
+    vector<CostEntry> entries;
+    for (size_t k = 0; k < trk_idx.size(); ++k) {
+        if (pair_dist[k] < INVALID_DIST) entries.push_back({trk_idx[k], det_idx[k], pair_dist[k]});
+    }
+    return CostMatrix::sparse(trks.size(), dets.size(), move(entries));
+}
@@ -4,6 +4,8 @@
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <memory>
+#include <string>
+#include <utility>
 
 #include "tracking_export.h"
 #include "Track.h"
@@ -13,24 +15,107 @@ class Extractor;
 template<typename T>
 class TrackerManager;
 
-template<typename T>
-class FeatureMetric;
+class FeatureGallery;
+
+class ReIDArchive;
+
+class TaskPool;
+
+// How the appearance of a track is summarized in the gallery
+enum class AppearanceModel : uint8_t {
+    // the last 100 features, 200 KB per track
+    Full,
+    // an exponential moving average of the features
+    EMA,
+    // a few centroids updated by online k-means
+    KMeans
+};
+
+struct DeepSORTOptions {
+    // Drop pairs whose Mahalanobis distance to the predicted box exceeds the 0.95 chi-square quantile.
+    // Only meaningful with BoxScaled noise, off until it is benchmarked on MOTChallenge
+    bool motion_gate = false;
+    MotionNoise motion_noise = MotionNoise::BoxScaled;
+    // Extract appearance only for detections whose IoU gate admits more than one pairing
+    bool appearance_on_demand = false;
+    // In appearance-on-demand mode, frames after which a confirmed track gets a new feature anyway
+    int refresh_interval = 10;
+    AppearanceModel appearance = AppearanceModel::Full;
+    // Weight of the old average in the EMA model
+    float ema_momentum = 0.9f;
+    // Number of centroids in the k-means model
+    int kmeans_centroids = 8;
+    // Keep gallery features as int8 with a scale per feature, a quarter of the memory of float
+    bool int8_gallery = false;
+    // File written by fit_projection that reduces the features to fewer dimensions.
+    // Only used when the tracker loads its own ReID network
+    std::string projection;
+    // Deleted confirmed tracks whose appearance is archived, so that a track confirmed later
+    // may recover the ID of a similar one. 0 disables the archive
+    int64_t archive_size = 0;
+    // Max cosine distance between mean features for an ID to be recovered
+    float recovery_dist = 0.2f;
+    // Exact or bounded-time approximate matching of detections to tracks
+    AssociationOptions association;
+    // Runs crop preprocessing and assignment when given, must outlive the tracker
+    TaskPool *pool = nullptr;
+};
+
+struct DeepSORTStats : TrackerStats {
+    int64_t detections = 0;
+    int64_t extracted = 0;
+    // tracks that got back the ID of an archived track
+    int64_t recovered = 0;
+
+    // fraction of detections whose appearance extraction was skipped
+    float skipped_fraction() const {
+        return detections ? 1.0f - float(extracted) / float(detections) : 0.0f;
+    }
+};
+
+// Load the ReID network once, to be shared by the trackers of several streams.
+// projection is as DeepSORTOptions::projection.
+TRACKING_EXPORT std::shared_ptr<Extractor> make_shared_extractor(const std::string &projection = "");
 
 class TRACKING_EXPORT DeepSORT {
 public:
-    explicit DeepSORT(const std::array<int64_t, 2> &dim);
+    // a null extractor makes the tracker load its own
+    explicit DeepSORT(const std::array<int64_t, 2> &dim, const DeepSORTOptions &options = {},
+                      std::shared_ptr<Extractor> extractor = nullptr);
 
     ~DeepSORT();
 
     std::vector<Track> update(const std::vector<cv::Rect2f> &detections, cv::Mat ori_img);
 
+    const DeepSORTStats &stats() const { return _stats; }
+
+    // memory held by the tracker state, feature gallery and archive included, the ReID network excluded
+    size_t bytes() const;
+
+    // Kalman states, track life cycles, the ID counter and the feature galleries,
+    // to resume tracking in another process. Options and statistics are not included.
+    std::vector<uint8_t> snapshot() const;
+
+    // replace the state by a snapshot of a DeepSORT with the same frame size and appearance model.
+    // Throws, with the state unchanged, if it is not one or it has an ID archive and archive_size is 0
+    void restore(const std::vector<uint8_t> &snapshot);
+
 private:
     class TrackData;
 
-    std::vector<TrackData> data;
-    std::unique_ptr<Extractor> extractor;
+    void retire_tracks();
+
+    void recover_ids();
+
+    DeepSORTOptions options;
+    DeepSORTStats _stats;
+
+    std::shared_ptr<Extractor> extractor;
+    std::unique_ptr<FeatureGallery> gallery;
+    std::unique_ptr<ReIDArchive> archive;
+    // (gallery slot, ID) of confirmed tracks removed in this frame, to be archived
+    std::vector<std::pair<int, int>> retired;
     std::unique_ptr<TrackerManager<TrackData>> manager;
-    std::unique_ptr<FeatureMetric<TrackData>> feat_metric;
 };
 
 
@@ -1,71 +1,334 @@
 #include <algorithm>
+#include <chrono>
 
 #include "DeepSORT.h"
 #include "Extractor.h"
 #include "TrackerManager.h"
 #include "nn_matching.h"
+#include "FeatureGallery.h"
+#include "ReIDArchive.h"
 
 using namespace std;
 
+namespace {
+    // 0.95 quantile of the chi-square distribution with 4 degrees of freedom
+    const float chi2inv95 = 9.4877f;
+
+    const uint32_t snapshot_tag = 0x54525344;  // "DSRT"
+    const uint32_t snapshot_version = 4;
+
+    // part of box inside the image, at least one pixel so that the extractor always gets an input
+    cv::Mat crop(const cv::Mat &image, const cv::Rect2f &box) {
+        auto rect = cv::Rect(box) & cv::Rect(0, 0, image.cols, image.rows);
+        if (rect.empty()) {
+            rect = cv::Rect(min(max(int(box.x), 0), image.cols - 1), min(max(int(box.y), 0), image.rows - 1), 1, 1);
+        }
+        return image(rect);
+    }
+
+    // Embeddings of the detections in one frame, each detection goes through the extractor at most once.
+    class EmbeddingCache {
+    public:
+        EmbeddingCache(Extractor &extractor, TaskPool *pool,
+                       const vector<cv::Rect2f> &detections, const cv::Mat &ori_img)
+                : extractor(extractor), pool(pool), detections(detections), ori_img(ori_img),
+                  row(detections.size(), -1) {}
+
+        bool has(int d) const { return row[d] != -1; }
+
+        // number of detections extracted so far
+        int64_t extracted() const { return n_rows; }
+
+        // time spent in the extractor so far
+        double seconds = 0;
+
+        // embeddings of det_ids, extracting the missing ones in one batch
+        torch::Tensor get(const vector<int> &det_ids) {
+            vector<cv::Mat> boxes;
+            for (auto d:det_ids) {
+                if (row[d] == -1) {
+                    row[d] = n_rows++;
+                    boxes.push_back(crop(ori_img, detections[d]));
+                }
+            }
+            if (!boxes.empty()) {
+                auto start = chrono::steady_clock::now();
+                auto feats = extractor.extract(boxes, pool);
+                seconds += chrono::duration<double>(chrono::steady_clock::now() - start).count();
+                store = store.defined() ? torch::cat({store, feats}) : feats;
+            }
+
+            vector<int64_t> index;
+            for (auto d:det_ids) {
+                index.push_back(row[d]);
+            }
+            if (index.empty()) {
+                return torch::empty({0, store.defined() ? store.size(1) : 0});
+            }
+            return store.index_select(0, torch::from_blob(index.data(), {int64_t(index.size())},
+                                                          torch::kLong).to(store.device()));
+        }
+
+    private:
+        Extractor &extractor;
+        TaskPool *pool;
+        const vector<cv::Rect2f> &detections;
+        const cv::Mat &ori_img;
+
+        vector<int64_t> row;
+        int64_t n_rows = 0;
+        torch::Tensor store;
+    };
+}
+
 struct DeepSORT::TrackData {
     KalmanTracker kalman;
-    FeatureBundle feats;
+    int feat_slot = -1;
+    // frames since the last feature was added to the gallery
+    int feat_age = 0;
+    // whether the archive was searched for the ID of this track
+    bool id_checked = false;
 };
 
-DeepSORT::DeepSORT(const array<int64_t, 2> &dim)
-        : extractor(make_unique<Extractor>()),
-          manager(make_unique<TrackerManager<TrackData>>(data, dim)),
-          feat_metric(make_unique<FeatureMetric<TrackData>>(data)) {}
+shared_ptr<Extractor> make_shared_extractor(const string &projection) {
+    return make_shared<Extractor>(projection);
+}
+
+DeepSORT::DeepSORT(const array<int64_t, 2> &dim, const DeepSORTOptions &options, shared_ptr<Extractor> extractor)
+        : options(options),
+          extractor(extractor ? move(extractor) : make_shared_extractor(options.projection)),
+          gallery(make_unique<FeatureGallery>(this->extractor->feat_dim(), options)),
+          archive(options.archive_size ? make_unique<ReIDArchive>(gallery->feat_dim(), options.archive_size)
+                                       : nullptr),
+          manager(make_unique<TrackerManager<TrackData>>(
+                  dim,
+                  [this](TrackData &t) {
+                      if (t.feat_slot == -1) return;
+                      if (archive && t.kalman.id() != -1) {
+                          retired.emplace_back(t.feat_slot, t.kalman.id());
+                      } else {
+                          gallery->release(t.feat_slot);
+                      }
+                  },
+                  options.pool, options.association, options.motion_noise)) {}
 
 
 DeepSORT::~DeepSORT() = default;
 
+size_t DeepSORT::bytes() const {
+    return manager->bytes() + gallery->bytes() + (archive ? archive->bytes() : 0);
+}
+
+vector<uint8_t> DeepSORT::snapshot() const {
+    SnapshotWriter out;
+    out.put(snapshot_tag);
+    out.put(snapshot_version);
+    gallery->save_header(out);
+    manager->save(out, [this](const TrackData &t, SnapshotWriter &o) {
+        o.put(t.feat_age);
+        o.put(uint8_t(t.id_checked));
+        o.put(uint8_t(t.feat_slot != -1));
+        if (t.feat_slot != -1) gallery->save(t.feat_slot, o);
+    });
+    out.put(uint8_t(archive != nullptr));
+    if (archive) archive->save(out);
+    return move(out.data());
+}
+
+void DeepSORT::restore(const vector<uint8_t> &snapshot) {
+    // everything is read into new state first, so that a bad snapshot leaves the tracker as it was
+    SnapshotReader in(snapshot);
+    in.expect(snapshot_tag, snapshot_version);
+    auto loaded_gallery = make_unique<FeatureGallery>(extractor->feat_dim(), options);
+    // checked once, so that a snapshot of another appearance model fails even without features
+    loaded_gallery->check_header(in);
+    TrackerManager<TrackData> loaded(manager->dim(), nullptr, nullptr, {}, options.motion_noise);
+    loaded.load(in, [&loaded_gallery](TrackData &t, SnapshotReader &i) {
+        t.feat_age = i.get<int>();
+        t.id_checked = i.get<uint8_t>();
+        t.feat_slot = i.get<uint8_t>() ? loaded_gallery->load(i) : -1;
+    });
+
+    auto loaded_archive = options.archive_size ? make_unique<ReIDArchive>(loaded_gallery->feat_dim(),
+                                                                          options.archive_size) : nullptr;
+    if (in.get<uint8_t>()) {
+        if (!loaded_archive) {
+            throw runtime_error("Snapshot has an ID archive but the tracker keeps none");
+        }
+        loaded_archive->load(in);
+    }
+    if (!in.at_end()) {
+        throw runtime_error("Snapshot has trailing data");
+    }
+
+    // the tracks replaced are not archived, their gallery is dropped as a whole
+    manager->swap_tracks(loaded);
+    gallery = move(loaded_gallery);
+    archive = move(loaded_archive);
+    retired.clear();
+}
+
+// archive the mean appearance of removed confirmed tracks and release their gallery slots
+void DeepSORT::retire_tracks() {
+    if (retired.empty()) return;
+
+    vector<int> slots;
+    for (auto &r:retired) {
+        slots.push_back(r.first);
+    }
+    auto feats = gallery->mean(slots);
+    for (size_t i = 0; i < retired.size(); ++i) {
+        archive->add(retired[i].second, feats.data_ptr<float>() + i * gallery->feat_dim());
+        gallery->release(retired[i].first);
+    }
+    retired.clear();
+}
+
+// give tracks confirmed in this frame the ID of the archived track they resemble.
+// the ID they took on confirmation is left unused
+void DeepSORT::recover_ids() {
+    vector<int> trks, slots;
+    for (auto s:manager->slots()) {
+        auto &t = manager->track(s);
+        if (t.kalman.state() == TrackState::Confirmed && !t.id_checked && t.feat_slot != -1) {
+            t.id_checked = true;
+            trks.push_back(s);
+            slots.push_back(t.feat_slot);
+        }
+    }
+    if (trks.empty()) return;
+
+    auto feats = gallery->mean(slots);
+    for (size_t i = 0; i < trks.size(); ++i) {
+        auto id = archive->recover(feats.data_ptr<float>() + i * gallery->feat_dim(), options.recovery_dist);
+        if (id != -1) {
+            manager->track(trks[i]).kalman.recover_id(id);
+            ++_stats.recovered;
+        }
+    }
+}
+
 vector<Track> DeepSORT::update(const std::vector<cv::Rect2f> &detections, cv::Mat ori_img) {
     manager->predict();
     manager->remove_nan();
+    for (auto s:manager->slots()) {
+        ++manager->track(s).feat_age;
+    }
+
+    EmbeddingCache embeddings(*extractor, options.pool, detections, ori_img);
 
+    auto start = chrono::steady_clock::now();
     auto matched = manager->update(
             detections,
-            [this, &detections, &ori_img](const std::vector<int> &trk_ids, const std::vector<int> &det_ids) {
+            [this, &detections, &embeddings](const std::vector<int> &trk_ids, const std::vector<int> &det_ids) {
                 vector<cv::Rect2f> trks;
+                vector<int> slots;
                 for (auto t : trk_ids) {
-                    trks.push_back(data[t].kalman.rect());
+                    trks.push_back(manager->rects()[t]);
+                    slots.push_back(manager->track(t).feat_slot);
                 }
-                vector<cv::Mat> boxes;
                 vector<cv::Rect2f> dets;
                 for (auto d:det_ids) {
                     dets.push_back(detections[d]);
-                    boxes.push_back(ori_img(detections[d]));
                 }
+                if (trk_ids.empty() || det_ids.empty()) {
+                    return CostMatrix(trk_ids.size(), det_ids.size());
+                }
+
+                auto iou_mat = iou_dist(dets, trks, 0.8f);
+                if (options.motion_gate) {
+                    manager->gate_mahalanobis(trk_ids, dets, iou_mat, chi2inv95);
+                }
+
+                // appearance is only needed for detections with a valid pair. In appearance-on-demand mode,
+                // a pair alone in its row and column is matched whatever its cost, so only columns sharing
+                // a row or column with another pair, or overlapping a track due for refresh, are extracted
+                const auto n_trk = iou_mat.rows(), n_det = iou_mat.cols();
+                vector<int> row_deg(n_trk), col_deg(n_det);
+                iou_mat.for_each_valid([&](int i, int j, float &) {
+                    ++row_deg[i];
+                    ++col_deg[j];
+                });
+                vector<uint8_t> with_appearance(n_trk);
+                for (int64_t i = 0; i < n_trk; ++i) {
+                    with_appearance[i] = !options.appearance_on_demand || row_deg[i] > 1 || slots[i] == -1 ||
+                                         manager->track(trk_ids[i]).feat_age >= options.refresh_interval;
+                }
+                vector<uint8_t> need(n_det);
+                iou_mat.for_each_valid([&](int i, int j, float &) {
+                    if (with_appearance[i] || col_deg[j] > 1) need[j] = 1;
+                });
+                vector<int> col_pos(n_det, -1), need_dets;
+                for (int64_t j = 0; j < n_det; ++j) {
+                    if (need[j]) {
+                        col_pos[j] = need_dets.size();
+                        need_dets.push_back(det_ids[j]);
+                    }
+                }
+                if (need_dets.empty()) {
+                    return iou_mat;
+                }
+
+                // only tracks paired with a needed detection are compared by appearance
+                vector<int> row_pos(n_trk, -1), need_slots;
+                iou_mat.for_each_valid([&](int i, int j, float &) {
+                    if (need[j] && row_pos[i] == -1) {
+                        row_pos[i] = need_slots.size();
+                        need_slots.push_back(slots[i]);
+                    }
+                });
 
-                auto iou_mat = iou_dist(dets, trks);
-                auto feat_mat = feat_metric->distance(extractor->extract(boxes), trk_ids);
-                feat_mat.masked_fill_((iou_mat > 0.8f).__ior__(feat_mat > 0.2f), INVALID_DIST);
-                return feat_mat;
+                // pairs left without appearance keep their IoU distance, they are alone in their component
+                auto feat_mat = gallery->distance(embeddings.get(need_dets), need_slots);
+                feat_mat.gate(0.2f);
+                iou_mat.for_each_valid([&](int i, int j, float &c) {
+                    if (need[j]) c = feat_mat[row_pos[i]][col_pos[j]];
+                });
+                return iou_mat;
             },
             [this, &detections](const std::vector<int> &trk_ids, const std::vector<int> &det_ids) {
                 vector<cv::Rect2f> trks;
                 for (auto t : trk_ids) {
-                    trks.push_back(data[t].kalman.rect());
+                    trks.push_back(manager->rects()[t]);
                 }
                 vector<cv::Rect2f> dets;
                 for (auto &d:det_ids) {
                     dets.push_back(detections[d]);
                 }
-                auto iou_mat = iou_dist(dets, trks);
-                iou_mat.masked_fill_(iou_mat > 0.7f, INVALID_DIST);
-                return iou_mat;
+                return iou_dist(dets, trks, 0.7f);
             });
 
-    vector<cv::Mat> boxes;
-    vector<int> targets;
+    _stats.association_time += chrono::duration<double>(chrono::steady_clock::now() - start).count()
+                               - embeddings.seconds;
+
+    // in appearance-on-demand mode, only confirmed tracks that are new to the gallery or due for refresh
+    // trigger an extraction, features already extracted this frame are always kept
+    vector<int> slots, dets;
     for (auto[x, y]:matched) {
-        targets.emplace_back(x);
-        boxes.emplace_back(ori_img(detections[y]));
+        auto &t = manager->track(x);
+        if (options.appearance_on_demand && !embeddings.has(y) &&
+            (t.kalman.state() != TrackState::Confirmed ||
+             (t.feat_slot != -1 && t.feat_age < options.refresh_interval))) {
+            continue;
+        }
+        if (t.feat_slot == -1) {
+            t.feat_slot = gallery->acquire();
+        }
+        t.feat_age = 0;
+        slots.emplace_back(t.feat_slot);
+        dets.emplace_back(y);
     }
-    feat_metric->update(extractor->extract(boxes), targets);
+    gallery->add(embeddings.get(dets), slots);
+    if (archive) recover_ids();
+
+    ++_stats.frames;
+    _stats.detections += detections.size();
+    _stats.extracted += embeddings.extracted();
+    _stats.extraction_time += embeddings.seconds;
+    _stats.assignment = manager->assignment_stats();
 
     manager->remove_deleted();
+    if (archive) retire_tracks();
 
     return manager->visible_tracks();
 }
@@ -84,6 +84,35 @@ namespace {
         }
         return ret;
     }
+
+    const int crop_h = 128, crop_w = 64;
+
+    const float MEAN[] = {0.485f, 0.456f, 0.406f};
+    const float STD[] = {0.229f, 0.224f, 0.225f};
+
+    // pad batches to a few sizes so that the buffers and the network see stable shapes
+    int64_t bucket_size(int64_t n) {
+        int64_t b = 1;
+        while (b < n && b < 64) b *= 2;
+        return b < n ? (n + 63) / 64 * 64 : b;
+    }
+
+    // Resize a BGR crop and write it as normalized planar RGB.
+    void preprocess(const cv::Mat &crop, float *out) {
+        cv::Mat resized;
+        cv::resize(crop, resized, {crop_w, crop_h});
+        for (int c = 0; c < 3; ++c) {
+            // (x / 255 - mean) / std
+            auto scale = 1 / (255 * STD[c]), offset = -MEAN[c] / STD[c];
+            auto dst = out + c * crop_h * crop_w;
+            for (int y = 0; y < crop_h; ++y) {
+                auto src = resized.ptr<uint8_t>(y) + (2 - c);
+                for (int x = 0; x < crop_w; ++x) {
+                    dst[y * crop_w + x] = src[3 * x] * scale + offset;
+                }
+            }
+        }
+    }
 }
 
 NetImpl::NetImpl() {
@@ -124,29 +153,68 @@ void NetImpl::load_form(const std::string &bin_path) {
     fs.close();
 }
 
-Extractor::Extractor() {
+Extractor::Extractor(const string &projection) {
     net->load_form("weights/ckpt.bin");
     net->to(torch::kCUDA);
     net->eval();
+
+    if (projection.empty()) return;
+
+    // int32 input and output dimensions, the input mean, then the output x input matrix, row-major
+    ifstream fs(projection, ios_base::binary);
+    int32_t dims[2];
+    if (!fs.read(reinterpret_cast<char *>(dims), sizeof(dims)) || dims[0] != 512 || dims[1] <= 0) {
+        throw runtime_error("Cannot load projection " + projection);
+    }
+    auto mean = torch::empty({dims[0]});
+    auto matrix = torch::empty({dims[1], dims[0]});
+    fs.read(reinterpret_cast<char *>(mean.data_ptr<float>()), mean.numel() * sizeof(float));
+    fs.read(reinterpret_cast<char *>(matrix.data_ptr<float>()), matrix.numel() * sizeof(float));
+    if (!fs) {
+        throw runtime_error("Cannot load projection " + projection);
+    }
+    proj_mean = mean.cuda();
+    proj = matrix.cuda();
 }
 
-torch::Tensor Extractor::extract(vector<cv::Mat> input) {
+int64_t Extractor::feat_dim() const {
+    return proj.defined() ? proj.size(0) : 512;
+}
+
+torch::Tensor Extractor::extract(const vector<cv::Mat> &input, TaskPool *pool) {
     if (input.empty()) {
-        return torch::empty({0, 512});
+        return torch::empty({0, feat_dim()});
     }
 
     torch::NoGradGuard no_grad;
+    std::lock_guard<std::mutex> lock(mutex);
 
-    static const auto MEAN = torch::tensor({0.485f, 0.456f, 0.406f}).view({1, -1, 1, 1}).cuda();
-    static const auto STD = torch::tensor({0.229f, 0.224f, 0.225f}).view({1, -1, 1, 1}).cuda();
+    const auto n = int64_t(input.size());
+    const auto batch = bucket_size(n);
+    if (!host.defined() || host.size(0) < batch) {
+        host = torch::zeros({batch, 3, crop_h, crop_w}).pin_memory();
+        device = torch::zeros({batch, 3, crop_h, crop_w}, torch::device(torch::kCUDA));
+    }
 
-    vector<torch::Tensor> resized;
-    for (auto &x:input) {
-        cv::resize(x, x, {64, 128});
-        cv::cvtColor(x, x, cv::COLOR_RGB2BGR);
-        x.convertTo(x, CV_32F, 1.0 / 255);
-        resized.push_back(torch::from_blob(x.data, {128, 64, 3}));
+    // each crop is written straight into its slot of the batch
+    auto data = host.data_ptr<float>();
+    const auto stride = 3 * crop_h * crop_w;
+    if (pool) {
+        pool->parallel_for(n, [&](size_t i, size_t) { preprocess(input[i], data + i * stride); });
+    } else {
+        at::parallel_for(0, n, 1, [&](int64_t begin, int64_t end) {
+            for (auto i = begin; i < end; ++i) {
+                preprocess(input[i], data + i * stride);
+            }
+        });
+    }
+
+    auto x = device.narrow(0, 0, batch);
+    x.copy_(host.narrow(0, 0, batch));
+    auto feats = net(x).narrow(0, 0, n);
+    if (proj.defined()) {
+        feats = torch::matmul(feats - proj_mean, proj.t());
+        feats.div_(feats.norm(2, 1, true).clamp(1e-12));
     }
-    auto tensor = torch::stack(resized).cuda().permute({0, 3, 1, 2}).sub_(MEAN).div_(STD);
-    return net(tensor);
-}
\ No newline at end of file
+    return feats;
+}
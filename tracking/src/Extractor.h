@@ -5,6 +5,10 @@
 #include <opencv2/opencv.hpp>
 #include <vector>
 #include <string>
+#include <mutex>
+
+#include "tracking_export.h"
+#include "TaskPool.h"
 
 struct NetImpl : torch::nn::Module {
 public:
@@ -20,14 +24,28 @@ private:
 
 TORCH_MODULE(Net);
 
-class Extractor {
+class TRACKING_EXPORT Extractor {
 public:
-    Extractor();
+    // projection, if given, is a file written by fit_projection that maps the 512-d features to fewer dimensions
+    explicit Extractor(const std::string &projection = "");
+
+    // dimension of the features returned
+    int64_t feat_dim() const;
 
-    torch::Tensor extract(std::vector<cv::Mat> input); // return GPUTensor
+    // thread-safe, so that trackers of several streams can share one network.
+    // Crops are preprocessed on pool if given, otherwise on libtorch's threads.
+    torch::Tensor extract(const std::vector<cv::Mat> &input, TaskPool *pool = nullptr); // return GPUTensor
 
 private:
     Net net;
+
+    // features are mapped to normalize((x - proj_mean) proj^T) if defined
+    torch::Tensor proj_mean, proj;
+
+    std::mutex mutex;
+
+    // normalized planar batch, pinned on the host, reused and grown to the largest bucket seen
+    torch::Tensor host, device;
 };
 
 
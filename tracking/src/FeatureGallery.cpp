@@ -0,0 +1,268 @@
+#include <numeric>
+
+#include "FeatureGallery.h"
+
+using namespace std;
+
+namespace {
+    const int64_t initial_slots = 16;
+
+    // features kept by the full model
+    const int64_t budget = 100;
+
+    // a feature farther than this from every centroid starts a new one while there is room
+    const float centroid_spread = 0.1f;
+}
+
+FeatureGallery::FeatureGallery(int64_t feat_dim, const DeepSORTOptions &options)
+        : _feat_dim(feat_dim), model(options.appearance), momentum(options.ema_momentum),
+          rows(model == AppearanceModel::Full ? budget : model == AppearanceModel::EMA ? 1 : options.kmeans_centroids),
+          int8(options.int8_gallery) {
+    if (!(options.ema_momentum >= 0 && options.ema_momentum < 1)) {
+        throw runtime_error("ema_momentum must be in [0, 1)");
+    }
+    if (options.kmeans_centroids <= 0) {
+        throw runtime_error("kmeans_centroids must be positive");
+    }
+}
+
+size_t FeatureGallery::bytes() const {
+    size_t n = (count.capacity() + next.capacity() + hits.capacity()) * sizeof(int64_t) +
+               free_slots.capacity() * sizeof(int);
+    if (store.defined()) n += store.numel() * (int8 ? sizeof(int8_t) : sizeof(float));
+    if (scale.defined()) n += scale.numel() * sizeof(float);
+    return n;
+}
+
+int FeatureGallery::acquire() {
+    if (free_slots.empty()) {
+        grow();
+    }
+    auto slot = free_slots.back();
+    free_slots.pop_back();
+    count[slot] = next[slot] = 0;
+    return slot;
+}
+
+void FeatureGallery::release(int slot) {
+    free_slots.push_back(slot);
+}
+
+void FeatureGallery::grow() {
+    auto old_capacity = capacity;
+    capacity = max(2 * capacity, initial_slots);
+
+    // zeroed, as blending reads rows before they are first written
+    auto new_store = torch::zeros({capacity * rows, _feat_dim}, torch::device(torch::kCUDA).dtype(
+            int8 ? torch::kChar : torch::kFloat));
+    if (old_capacity) {
+        new_store.slice(0, 0, old_capacity * rows).copy_(store);
+    }
+    store = new_store;
+    if (int8) {
+        auto new_scale = torch::zeros({capacity * rows, 1}, torch::device(torch::kCUDA));
+        if (old_capacity) {
+            new_scale.slice(0, 0, old_capacity * rows).copy_(scale);
+        }
+        scale = new_scale;
+    }
+
+    count.resize(capacity);
+    next.resize(capacity);
+    hits.resize(capacity * rows);
+    for (auto s = capacity - 1; s >= old_capacity; --s) {
+        free_slots.push_back(s);
+    }
+}
+
+void FeatureGallery::add(torch::Tensor feats, const vector<int> &slots) {
+    if (slots.empty()) return;
+
+    vector<int64_t> index;
+    vector<float> keep;
+    switch (model) {
+        case AppearanceModel::Full:
+            for (auto s:slots) {
+                index.push_back(s * rows + next[s]);
+                next[s] = (next[s] + 1) % rows;
+                count[s] = min(count[s] + 1, rows);
+            }
+            write_rows(torch::from_blob(index.data(), {int64_t(index.size())}, torch::kLong).cuda(), feats);
+            return;
+        case AppearanceModel::EMA:
+            for (auto s:slots) {
+                index.push_back(s * rows);
+                keep.push_back(count[s] ? momentum : 0);
+                count[s] = 1;
+            }
+            break;
+        case AppearanceModel::KMeans: {
+            // online k-means, each centroid is the running mean of the features merged into it
+            auto nearest = nearest_centroids(feats, slots);
+            for (size_t i = 0; i < slots.size(); ++i) {
+                auto s = slots[i];
+                auto[k, dist] = nearest[i];
+                if (k == -1 || (dist > centroid_spread && count[s] < rows)) {
+                    k = count[s]++;
+                    hits[s * rows + k] = 0;
+                }
+                auto h = ++hits[s * rows + k];
+                index.push_back(s * rows + k);
+                keep.push_back(1 - 1.0f / h);
+            }
+            break;
+        }
+    }
+    blend(feats, index, keep);
+}
+
+torch::Tensor FeatureGallery::gather(vector<int64_t> &slots) const {
+    auto index = torch::from_blob(slots.data(), {int64_t(slots.size())}, torch::kLong).cuda();
+    auto g = store.view({capacity, rows, _feat_dim}).index_select(0, index);
+    if (!int8) return g;
+    return g.to(torch::kFloat) * scale.view({capacity, rows, 1}).index_select(0, index);
+}
+
+torch::Tensor FeatureGallery::read_rows(const torch::Tensor &index) const {
+    auto r = store.index_select(0, index);
+    if (!int8) return r;
+    return r.to(torch::kFloat) * scale.index_select(0, index);
+}
+
+void FeatureGallery::write_rows(const torch::Tensor &index, torch::Tensor values) {
+    if (!int8) {
+        store.index_copy_(0, index, values);
+        return;
+    }
+    // symmetric quantization, the largest magnitude of a row maps to 127
+    auto s = std::get<0>(values.abs().max(1, true)).clamp(1e-12) / 127;
+    store.index_copy_(0, index, (values / s).round().to(torch::kChar));
+    scale.index_copy_(0, index, s);
+}
+
+vector<pair<int64_t, float>> FeatureGallery::nearest_centroids(torch::Tensor feats, const vector<int> &slots) {
+    vector<int64_t> index;
+    vector<float> penalty;
+    for (auto s:slots) {
+        index.push_back(s);
+        for (int64_t k = 0; k < rows; ++k) {
+            penalty.push_back(k >= count[s] ? INVALID_DIST : 0);
+        }
+    }
+    auto n = int64_t(slots.size());
+    auto d = 1 - torch::bmm(gather(index), feats.view({n, _feat_dim, 1})).view({n, rows});
+    d.add_(torch::from_blob(penalty.data(), {n, rows}).cuda());
+    auto nearest = d.min(1);
+    torch::Tensor dist = std::get<0>(nearest).cpu().contiguous();
+    torch::Tensor row = std::get<1>(nearest).cpu().contiguous();
+
+    vector<pair<int64_t, float>> out;
+    for (int64_t i = 0; i < n; ++i) {
+        auto v = dist.data_ptr<float>()[i];
+        out.emplace_back(v < INVALID_DIST ? row.data_ptr<int64_t>()[i] : -1, v);
+    }
+    return out;
+}
+
+void FeatureGallery::blend(torch::Tensor feats, vector<int64_t> &index, vector<float> &keep) {
+    auto n = int64_t(index.size());
+    auto rows_index = torch::from_blob(index.data(), {n}, torch::kLong).cuda();
+    auto w = torch::from_blob(keep.data(), {n, 1}).cuda();
+    auto blended = read_rows(rows_index) * w + feats * (1 - w);
+    write_rows(rows_index, blended / blended.norm(2, 1, true).clamp(1e-12));
+}
+
+torch::Tensor FeatureGallery::mean(const vector<int> &slots) {
+    vector<int64_t> index;
+    vector<float> weight;
+    for (auto s:slots) {
+        index.push_back(s);
+        for (int64_t k = 0; k < rows; ++k) {
+            // centroids count as many times as the features they summarize
+            auto w = model == AppearanceModel::KMeans ? float(hits[s * rows + k]) : 1;
+            weight.push_back(k < count[s] ? w : 0);
+        }
+    }
+    auto n = int64_t(slots.size());
+    auto sum = (gather(index) * torch::from_blob(weight.data(), {n, rows, 1}).cuda()).sum(1);
+    return (sum / sum.norm(2, 1, true).clamp(1e-12)).cpu().contiguous();
+}
+
+void FeatureGallery::save_header(SnapshotWriter &out) const {
+    out.put(model);
+    out.put(rows);
+    out.put(_feat_dim);
+}
+
+void FeatureGallery::check_header(SnapshotReader &in) const {
+    if (in.get<AppearanceModel>() != model || in.get<int64_t>() != rows || in.get<int64_t>() != _feat_dim) {
+        throw runtime_error("Snapshot has another appearance model");
+    }
+}
+
+void FeatureGallery::save(int slot, SnapshotWriter &out) const {
+    out.put(count[slot]);
+    if (!count[slot]) return;
+
+    // the ring buffer has wrapped once full, the oldest feature is the next to be overwritten
+    auto oldest = model == AppearanceModel::Full && count[slot] == rows ? next[slot] : 0;
+    vector<int64_t> index;
+    for (int64_t k = 0; k < count[slot]; ++k) {
+        index.push_back(slot * rows + (oldest + k) % rows);
+    }
+    auto rows_index = torch::from_blob(index.data(), {int64_t(index.size())}, torch::kLong).cuda();
+    torch::Tensor feats = read_rows(rows_index).cpu().contiguous();
+    out.write(feats.data_ptr<float>(), feats.numel() * sizeof(float));
+    if (model == AppearanceModel::KMeans) {
+        out.write(&hits[slot * rows], count[slot] * sizeof(int64_t));
+    }
+}
+
+int FeatureGallery::load(SnapshotReader &in) {
+    auto n = in.get<int64_t>();
+    if (n < 0 || n > rows) {
+        throw runtime_error("Snapshot has more features than the appearance model holds");
+    }
+
+    auto slot = acquire();
+    if (n) {
+        auto feats = torch::empty({n, _feat_dim});
+        in.read(feats.data_ptr<float>(), feats.numel() * sizeof(float));
+        vector<int64_t> index(n);
+        iota(index.begin(), index.end(), slot * rows);
+        write_rows(torch::from_blob(index.data(), {n}, torch::kLong).cuda(), feats.cuda());
+        if (model == AppearanceModel::KMeans) {
+            in.read(&hits[slot * rows], n * sizeof(int64_t));
+        }
+    }
+    count[slot] = n;
+    next[slot] = n % rows;
+    return slot;
+}
+
+CostMatrix FeatureGallery::distance(torch::Tensor features, const vector<int> &slots) {
+    CostMatrix dist(slots.size(), features.size(0), INVALID_DIST);
+    if (slots.empty() || !features.size(0)) {
+        return dist;
+    }
+
+    // gather the rows of the slots, unused rows are pushed out of reach of the min
+    vector<int64_t> index;
+    vector<float> penalty;
+    for (auto s:slots) {
+        index.push_back(s == -1 ? 0 : s);
+        for (int64_t k = 0; k < rows; ++k) {
+            penalty.push_back(s == -1 || k >= count[s] ? INVALID_DIST : 0);
+        }
+    }
+    auto n = int64_t(slots.size());
+    auto d = 1 - torch::matmul(gather(index).view({n * rows, _feat_dim}), features.t());
+    d.add_(torch::from_blob(penalty.data(), {n * rows, 1}).cuda());
+    torch::Tensor nearest = std::get<0>(d.view({n, rows, -1}).min(1)).cpu().contiguous();
+
+    auto acc = nearest.data_ptr<float>();
+    for (int64_t k = 0; k < dist.size(); ++k) {
+        dist.data()[k] = min(acc[k], INVALID_DIST);
+    }
+    return dist;
+}
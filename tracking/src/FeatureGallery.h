@@ -0,0 +1,85 @@
+#ifndef FEATURE_GALLERY_H
+#define FEATURE_GALLERY_H
+
+#include <torch/torch.h>
+#include <vector>
+
+#include "DeepSORT.h"
+#include "CostMatrix.h"
+#include "Snapshot.h"
+
+// Appearance features of all tracks, saved in one slab in GPU.
+// A track owns a slot of rows acquired when it gets its first feature. Depending on the model,
+// the rows are a ring buffer of the last features, one moving average or a few centroids.
+// In int8 mode each row is kept as int8 with its own scale and turned back to float when read.
+class FeatureGallery {
+public:
+    FeatureGallery(int64_t feat_dim, const DeepSORTOptions &options);
+
+    int64_t feat_dim() const { return _feat_dim; }
+
+    // memory held by the slab, on whichever device it lives, and the bookkeeping of the slots
+    size_t bytes() const;
+
+    int acquire();
+
+    void release(int slot);
+
+    // merge feats[i] into the rows of slots[i]
+    void add(torch::Tensor feats, const std::vector<int> &slots);
+
+    // min cosine distance between each slot and each feature, computed by one matmul over all slots.
+    // this is where appearance features leave torch, the result is a plain cost matrix
+    CostMatrix distance(torch::Tensor features, const std::vector<int> &slots);
+
+    // unit mean of the features in each slot, on CPU
+    torch::Tensor mean(const std::vector<int> &slots);
+
+    // appearance model, rows per slot and feature size, written once ahead of the slots
+    void save_header(SnapshotWriter &out) const;
+
+    // throw if the header is from a gallery of another appearance model
+    void check_header(SnapshotReader &in) const;
+
+    // rows of a slot, oldest first
+    void save(int slot, SnapshotWriter &out) const;
+
+    // acquire a slot holding saved rows of a gallery whose header passed check_header
+    int load(SnapshotReader &in);
+
+private:
+    void grow();
+
+    // rows of the slots as float, n x rows x feat_dim
+    torch::Tensor gather(std::vector<int64_t> &slots) const;
+
+    // rows of store at index as float, and writing them back
+    torch::Tensor read_rows(const torch::Tensor &index) const;
+
+    void write_rows(const torch::Tensor &index, torch::Tensor values);
+
+    // for each feature, the nearest centroid of its slot as (row in the slot, distance), row -1 if there is none
+    std::vector<std::pair<int64_t, float>> nearest_centroids(torch::Tensor feats, const std::vector<int> &slots);
+
+    // row[i] = normalize(keep[i] * row[i] + (1 - keep[i]) * feats[i]) for the rows in index
+    void blend(torch::Tensor feats, std::vector<int64_t> &index, std::vector<float> &keep);
+
+    const int64_t _feat_dim;
+    const AppearanceModel model;
+    const float momentum;
+    // rows per slot
+    const int64_t rows;
+    const bool int8;
+
+    // capacity * rows rows of feat_dim, and the scale of each row in int8 mode
+    torch::Tensor store, scale;
+    int64_t capacity = 0;
+
+    // rows in use of each slot, and the next row to overwrite of the ring buffer
+    std::vector<int64_t> count, next;
+    // features merged into each centroid
+    std::vector<int64_t> hits;
+    std::vector<int> free_slots;
+};
+
+#endif //FEATURE_GALLERY_H
@@ -0,0 +1,84 @@
+#include <stdexcept>
+
+#include "ReIDArchive.h"
+
+using namespace std;
+
+namespace {
+    // neighbours looked at, in case the nearest ones were recovered already
+    const int n_neighbours = 4;
+}
+
+ReIDArchive::ReIDArchive(int feat_dim, int64_t capacity)
+        : feat_dim(feat_dim), capacity(capacity),
+          older(make_unique<Generation>(feat_dim)), newer(make_unique<Generation>(feat_dim)) {}
+
+size_t ReIDArchive::size() const {
+    return older->ids.size() + newer->ids.size();
+}
+
+size_t ReIDArchive::bytes() const {
+    size_t n = 0;
+    for (auto g:{older.get(), newer.get()}) {
+        n += g->index.bytes() + g->ids.capacity() * sizeof(int) + g->taken.capacity();
+    }
+    return n;
+}
+
+void ReIDArchive::add(int id, const float *feat) {
+    if (int64_t(newer->ids.size()) >= max<int64_t>(capacity / 2, 1)) {
+        older = move(newer);
+        newer = make_unique<Generation>(feat_dim);
+    }
+    newer->index.add(feat);
+    newer->ids.push_back(id);
+    newer->taken.push_back(0);
+}
+
+int ReIDArchive::recover(const float *feat, float max_dist) {
+    Generation *best_gen = nullptr;
+    int best = -1;
+    auto best_dist = max_dist;
+    for (auto gen:{older.get(), newer.get()}) {
+        for (auto[dist, i]:gen->index.search(feat, n_neighbours)) {
+            if (!gen->taken[i] && dist <= best_dist) {
+                best_gen = gen;
+                best = i;
+                best_dist = dist;
+                break;
+            }
+        }
+    }
+    if (!best_gen) return -1;
+
+    best_gen->taken[best] = 1;
+    return best_gen->ids[best];
+}
+
+void ReIDArchive::save(SnapshotWriter &out) const {
+    out.put(int64_t(feat_dim));
+    for (auto gen:{older.get(), newer.get()}) {
+        out.put(uint32_t(gen->ids.size()));
+        for (size_t i = 0; i < gen->ids.size(); ++i) {
+            out.put(gen->ids[i]);
+            out.put(gen->taken[i]);
+            out.write(gen->index.point(int(i)), feat_dim * sizeof(float));
+        }
+    }
+}
+
+void ReIDArchive::load(SnapshotReader &in) {
+    if (in.get<int64_t>() != feat_dim) {
+        throw runtime_error("Snapshot has features of another size");
+    }
+    vector<float> feat(feat_dim);
+    for (auto gen:{&older, &newer}) {
+        *gen = make_unique<Generation>(feat_dim);
+        for (auto n = in.get<uint32_t>(); n > 0; --n) {
+            (*gen)->ids.push_back(in.get<int>());
+            (*gen)->taken.push_back(in.get<uint8_t>());
+            in.read(feat.data(), feat_dim * sizeof(float));
+            (*gen)->index.add(feat.data());
+        }
+    }
+}
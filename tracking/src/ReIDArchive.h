@@ -0,0 +1,49 @@
+#ifndef REID_ARCHIVE_H
+#define REID_ARCHIVE_H
+
+#include <memory>
+#include <vector>
+
+#include "HNSW.h"
+#include "Snapshot.h"
+
+// Mean appearance of deleted tracks, kept so that a returning target gets its old ID back.
+// At most capacity identities are kept in two generations of HNSW indices.
+// When the newer generation holds half of them, the older one is dropped as a whole,
+// since points cannot be removed from an index.
+class ReIDArchive {
+public:
+    ReIDArchive(int feat_dim, int64_t capacity);
+
+    // archive the unit mean feature of a deleted track
+    void add(int id, const float *feat);
+
+    // ID of the nearest archived identity within max_dist, which leaves the archive, or -1
+    int recover(const float *feat, float max_dist);
+
+    size_t size() const;
+
+    // memory held by both generations
+    size_t bytes() const;
+
+    void save(SnapshotWriter &out) const;
+
+    // replace the archive by a saved one, rebuilding the indices
+    void load(SnapshotReader &in);
+
+private:
+    struct Generation {
+        explicit Generation(int feat_dim) : index(feat_dim) {}
+
+        HNSW index;
+        std::vector<int> ids;
+        // recovered identities stay in the index until the generation is dropped
+        std::vector<uint8_t> taken;
+    };
+
+    int feat_dim;
+    int64_t capacity;
+    std::unique_ptr<Generation> older, newer;
+};
+
+#endif //REID_ARCHIVE_H